@@ -0,0 +1,69 @@
+#ifndef ASTARSEARCH_H
+#define ASTARSEARCH_H
+
+#include "SearchContext.h"
+
+// ----------------------------------------------------------------
+//  Name:           aStarSearch
+//  Description:    The A* loop shared by Graph and GraphCSR. The
+//                  graph type only has to provide
+//
+//                      forEachArc(node, visit)  calls visit(target,
+//                                               weight) per arc
+//                      heuristic(node, dest)    estimate to dest
+//
+//                  The open list comes from the context, so the
+//                  queue implementation is chosen by the context's
+//                  OpenList template parameter. Heuristics already
+//                  in the context (see Graph::setHeuristics) are
+//                  used as they are; missing ones are computed when
+//                  a node is first reached. The context is not
+//                  reset here.
+//  Arguments:      The graph, start and destination node indices
+//                  and the search context.
+//  Return Value:   true if dest was reached. The path can be read
+//                  back through context.previous().
+// ----------------------------------------------------------------
+template<class SearchGraph, class Context>
+bool aStarSearch(const SearchGraph& graph, int start, int dest, Context& context) {
+	typedef typename Context::CostType NodeType;
+	typename Context::OpenListType& open = context.openList();
+
+	context.setState(start, Context::OPEN);
+	context.setGCost(start, NodeType());
+	if (context.hCost(start) == -1)
+		context.setHCost(start, graph.heuristic(start, dest));
+	open.push(start, context.fCost(start), NodeType());
+
+	while (open.empty() == false) {
+		int current = open.pop();
+		// a lazy open list leaves old entries behind when a cost improves
+		if (context.state(current) == Context::CLOSED)
+			continue;
+		context.setState(current, Context::CLOSED);
+		if (current == dest)
+			return true;
+
+		NodeType currentG = context.gCost(current);
+		graph.forEachArc(current, [&](int child, auto weight) {
+			if (context.state(child) == Context::CLOSED)
+				return;
+			NodeType Gc = currentG + weight;
+			if (context.state(child) == Context::UNVISITED) {
+				if (context.hCost(child) == -1)
+					context.setHCost(child, graph.heuristic(child, dest));
+			}
+			else if (Gc >= context.gCost(child)) {
+				return;
+			}
+			context.setState(child, Context::OPEN);
+			context.setGCost(child, Gc);
+			context.setPrevious(child, current);
+			open.push(child, Gc + context.hCost(child), Gc);
+		});
+	}
+
+	return false;
+}
+
+#endif
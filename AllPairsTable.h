@@ -0,0 +1,235 @@
+#ifndef ALLPAIRSTABLE_H
+#define ALLPAIRSTABLE_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "ParallelFor.h"
+
+// ----------------------------------------------------------------
+//  Name:           AllPairsTable
+//  Description:    Every shortest path of a snapshot, precomputed.
+//                  Holds an n x n distance matrix and an n x n
+//                  next hop matrix (the node after s on a shortest
+//                  path from s to t), so a distance is one load and
+//                  a path is one load per node on it. Meant for
+//                  graphs of up to a few thousand nodes that are
+//                  queried very often; memory is n * n distances
+//                  plus n * n ints.
+//
+//                  build() is Floyd-Warshall in square blocks
+//                  (Venkataraman et al.). For each block k along
+//                  the diagonal: the diagonal block is relaxed
+//                  through itself, then the rest of block row and
+//                  column k through it, then every other block
+//                  through its row and column blocks. Three blocks
+//                  fit in cache at a time, and the blocks of the
+//                  last two steps are independent, so they are
+//                  shared out between threads, which are started
+//                  once per build and wait at a barrier between
+//                  steps.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class AllPairsTable {
+private:
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+// ----------------------------------------------------------------
+//  Description:    Row major, m_stride entries per row. The stride
+//                  is n rounded up to whole blocks; the padding
+//                  rows and columns stay unreachable.
+// ----------------------------------------------------------------
+	std::vector<NodeType> m_distances;
+	std::vector<int> m_next;
+	int m_count;
+	int m_stride;
+
+// ----------------------------------------------------------------
+//  Description:    Block side. Three blocks of distances and next
+//                  hops (3 * 2 * 64 * 64 * 4 bytes) fit in a 256KB
+//                  L2 cache.
+// ----------------------------------------------------------------
+	static const int BLOCK_SIZE = 64;
+
+// ----------------------------------------------------------------
+//  Description:    Unreachable. Half the type's maximum, so adding
+//                  two of them cannot overflow.
+// ----------------------------------------------------------------
+	static const NodeType INFINITE_COST;
+
+	void relaxBlock(int row, int column, int pivot);
+
+public:
+	AllPairsTable(const GraphCSR<NodeType, ArcType>& graph) :
+	m_graph(graph),
+	m_count(0),
+	m_stride(0) {
+	}
+
+	void build(int threadCount = 0);
+
+	NodeType distance(int start, int dest) const;
+	bool query(int start, int dest, std::vector<int>& path) const;
+
+    // Accessors
+	int nodeCount() const {
+		return m_count;
+	}
+
+	// the node after start on a shortest path to dest, -1 if none
+	int nextHop(int start, int dest) const {
+		return m_next[(size_t)start * m_stride + dest];
+	}
+};
+
+template<class NodeType, class ArcType>
+const NodeType AllPairsTable<NodeType, ArcType>::INFINITE_COST = std::numeric_limits<NodeType>::max() / 2;
+
+// ----------------------------------------------------------------
+//  Name:           relaxBlock
+//  Description:    The min-plus kernel. Relaxes every pair (i, j)
+//                  of the target block through every node k of the
+//                  pivot block:
+//                      d(i, j) = min(d(i, j), d(i, k) + d(k, j))
+//                  where the target block is at (row, column),
+//                  d(i, k) is read from the block at (row, pivot)
+//                  and d(k, j) from the block at (pivot, column).
+//                  k is the outer loop, so the target may be one of
+//                  the other two blocks. The innermost loop runs
+//                  along a row with the updates written as selects
+//                  rather than branches, so the compiler can
+//                  vectorise it.
+//  Arguments:      The block row and column of the target block
+//                  and the pivot block.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void AllPairsTable<NodeType, ArcType>::relaxBlock(int row, int column, int pivot) {
+	size_t stride = (size_t)m_stride;
+	int rowBase = row * BLOCK_SIZE;
+	int columnBase = column * BLOCK_SIZE;
+	int pivotBase = pivot * BLOCK_SIZE;
+
+	for (int k = 0; k < BLOCK_SIZE; k++) {
+		const NodeType* through = &m_distances[(pivotBase + k) * stride + columnBase];
+		for (int i = 0; i < BLOCK_SIZE; i++) {
+			size_t rowStart = (rowBase + i) * stride;
+			NodeType toPivot = m_distances[rowStart + pivotBase + k];
+			if (toPivot >= INFINITE_COST)
+				continue;
+			int hop = m_next[rowStart + pivotBase + k];
+			NodeType* distances = &m_distances[rowStart + columnBase];
+			int* next = &m_next[rowStart + columnBase];
+			for (int j = 0; j < BLOCK_SIZE; j++) {
+				NodeType length = toPivot + through[j];
+				bool shorter = length < distances[j];
+				distances[j] = shorter ? length : distances[j];
+				next[j] = shorter ? hop : next[j];
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Fills the tables from the snapshot. Call again
+//                  after the snapshot changes.
+//  Arguments:      The number of threads, 0 for one per hardware
+//                  thread.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void AllPairsTable<NodeType, ArcType>::build(int threadCount) {
+	threadCount = threadCountOrDefault(threadCount);
+	m_count = m_graph.nodeCount();
+	int blocks = (m_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	m_stride = blocks * BLOCK_SIZE;
+	size_t stride = (size_t)m_stride;
+
+	m_distances.assign(stride * stride, INFINITE_COST);
+	m_next.assign(stride * stride, -1);
+	for (int node = 0; node < m_count; node++) {
+		m_distances[node * stride + node] = NodeType();
+		m_next[node * stride + node] = node;
+		m_graph.forEachArc(node, [&](int target, ArcType weight) {
+			size_t cell = node * stride + target;
+			if ((NodeType)weight < m_distances[cell]) {
+				m_distances[cell] = (NodeType)weight;
+				m_next[cell] = target;
+			}
+		});
+	}
+
+	// the threads are started once for the whole build; every pivot
+	// has three phases, with the blocks of a phase dealt out in turn
+	threadCount = std::max(std::min(threadCount, blocks * blocks), 1);
+	Barrier barrier(threadCount);
+	runThreads(threadCount, [&](int thread) {
+		for (int pivot = 0; pivot < blocks; pivot++) {
+			if (thread == 0)
+				relaxBlock(pivot, pivot, pivot);
+			barrier.wait();
+
+			// block row and column of the pivot, 2 * (blocks - 1) of them
+			for (int item = thread; item < 2 * blocks; item += threadCount) {
+				int other = item / 2;
+				if (other == pivot)
+					continue;
+				if (item % 2 == 0)
+					relaxBlock(pivot, other, pivot);
+				else
+					relaxBlock(other, pivot, pivot);
+			}
+			barrier.wait();
+
+			for (int item = thread; item < blocks * blocks; item += threadCount) {
+				int row = item / blocks;
+				int column = item % blocks;
+				if (row != pivot && column != pivot)
+					relaxBlock(row, column, pivot);
+			}
+			barrier.wait();
+		}
+	});
+}
+
+// ----------------------------------------------------------------
+//  Name:           distance
+//  Description:    The shortest path cost between two nodes.
+//  Arguments:      The start and destination node indices.
+//  Return Value:   The cost, -1 if there is no path or a node is
+//                  out of range.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType AllPairsTable<NodeType, ArcType>::distance(int start, int dest) const {
+	if (start < 0 || start >= m_count || dest < 0 || dest >= m_count)
+		return NodeType(-1);
+	NodeType cost = m_distances[(size_t)start * m_stride + dest];
+	return cost >= INFINITE_COST ? NodeType(-1) : cost;
+}
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    Shortest path between two nodes by following
+//                  next hops; the same answer as aStar without a
+//                  search.
+//  Arguments:      The start and destination node indices and the
+//                  vector the path (start to dest) is written to.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool AllPairsTable<NodeType, ArcType>::query(int start, int dest, std::vector<int>& path) const {
+	if (start < 0 || start >= m_count || dest < 0 || dest >= m_count || nextHop(start, dest) == -1)
+		return false;
+
+	path.clear();
+	path.push_back(start);
+	for (int node = start; node != dest; ) {
+		node = nextHop(node, dest);
+		path.push_back(node);
+	}
+	return true;
+}
+
+#endif
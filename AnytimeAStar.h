@@ -0,0 +1,265 @@
+#ifndef ANYTIMEASTAR_H
+#define ANYTIMEASTAR_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "OpenList.h"
+
+// ----------------------------------------------------------------
+//  Name:           AnytimeAStar
+//  Description:    Weighted A* and Anytime Repairing A* (ARA*).
+//
+//                  Weighted A* orders the open list on g + e * h.
+//                  With e above 1 the search heads for the
+//                  destination and expands far fewer nodes, and the
+//                  path it returns costs at most e times the
+//                  optimal one. search() runs one such pass.
+//
+//                  improve() then lowers e and repairs the last
+//                  pass instead of starting over: costs are kept,
+//                  nodes whose cost dropped after they were closed
+//                  (the incons list) are put back on the open list
+//                  and only they and what they affect are expanded
+//                  again. Both calls return the path together with
+//                  a bound on how far it can be from optimal, which
+//                  may already be lower than e.
+//
+//                  The search state lives in the object between
+//                  calls. Paths are node indices in the snapshot;
+//                  Graph::nodePath turns them into nodes. After the
+//                  snapshot changes start again with search().
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class AnytimeAStar {
+private:
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+	std::vector<NodeType> m_g;
+	std::vector<NodeType> m_h;
+	std::vector<int> m_previous;
+	IndexedOpenList<NodeType> m_open;
+
+// ----------------------------------------------------------------
+//  Description:    A node is closed if its stamp is the current
+//                  pass, so every pass starts with an empty closed
+//                  list without clearing it.
+// ----------------------------------------------------------------
+	std::vector<unsigned int> m_closed;
+	unsigned int m_pass;
+
+// ----------------------------------------------------------------
+//  Description:    Closed nodes whose cost has dropped since they
+//                  were expanded. They wait here until the next
+//                  pass rather than being expanded again in this
+//                  one, which is what keeps each pass cheap.
+// ----------------------------------------------------------------
+	std::vector<int> m_incons;
+	std::vector<unsigned char> m_inconsistent;
+
+	int m_start;
+	int m_dest;
+	float m_epsilon;
+	float m_bound;
+	int m_expanded;
+
+	static const NodeType INFINITE_COST;
+
+	NodeType heuristic(int node) {
+		if (m_h[node] == NodeType(-1))
+			m_h[node] = m_graph.heuristic(node, m_dest);
+		return m_h[node];
+	}
+
+	NodeType fValue(int node) {
+		return m_g[node] + (NodeType)(m_epsilon * heuristic(node));
+	}
+
+	void improvePath();
+	bool finishPass(std::vector<int>& path, float& bound);
+
+public:
+	AnytimeAStar(const GraphCSR<NodeType, ArcType>& graph) :
+	m_graph(graph),
+	m_pass(0),
+	m_start(-1),
+	m_dest(-1),
+	m_epsilon(1),
+	m_bound(1),
+	m_expanded(0) {
+	}
+
+	bool search(int start, int dest, float epsilon, std::vector<int>& path, float& bound);
+	bool improve(float epsilon, std::vector<int>& path, float& bound);
+
+    // Accessors
+	float epsilon() const {
+		return m_epsilon;
+	}
+
+	// the bound of the last path returned, 1 once it is optimal
+	float bound() const {
+		return m_bound;
+	}
+
+// ----------------------------------------------------------------
+//  Name:           expanded
+//  Description:    Nodes expanded by the last call to search or
+//                  improve.
+// ----------------------------------------------------------------
+	int expanded() const {
+		return m_expanded;
+	}
+};
+
+template<class NodeType, class ArcType>
+const NodeType AnytimeAStar<NodeType, ArcType>::INFINITE_COST = std::numeric_limits<NodeType>::max();
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Starts a new search and runs one weighted A*
+//                  pass. Used on its own this is plain weighted A*.
+//  Arguments:      The start and destination node indices, the
+//                  weight e (at least 1) on the heuristic, the
+//                  vector the path is written to and the bound the
+//                  path's cost is within, as a multiple of the
+//                  optimal cost.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool AnytimeAStar<NodeType, ArcType>::search(int start, int dest, float epsilon, std::vector<int>& path, float& bound) {
+	int count = m_graph.nodeCount();
+	m_start = -1;
+	m_expanded = 0;
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+
+	m_g.assign(count, INFINITE_COST);
+	m_h.assign(count, NodeType(-1));
+	m_previous.assign(count, -1);
+	m_closed.assign(count, 0);
+	m_inconsistent.assign(count, 0);
+	m_incons.clear();
+	m_open.resize(count);
+	m_pass = 1;
+	m_start = start;
+	m_dest = dest;
+	m_epsilon = std::max(epsilon, 1.0f);
+
+	m_g[start] = NodeType();
+	m_open.push(start, fValue(start), NodeType());
+	improvePath();
+	return finishPass(path, bound);
+}
+
+// ----------------------------------------------------------------
+//  Name:           improve
+//  Description:    Lowers e and runs another pass over the state
+//                  left by the last one. The incons list is merged
+//                  into the open list, every open node is queued
+//                  again under the new weight and the closed list
+//                  starts empty.
+//  Arguments:      The new weight, which should be lower than the
+//                  current one (1 asks for the optimal path), the
+//                  vector the path is written to and the bound.
+//  Return Value:   true if a path was found; false without a
+//                  search to improve or if there is no path.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool AnytimeAStar<NodeType, ArcType>::improve(float epsilon, std::vector<int>& path, float& bound) {
+	if (m_start == -1 || (int)m_g.size() != m_graph.nodeCount())
+		return false;
+	m_expanded = 0;
+	if (m_g[m_dest] == INFINITE_COST)
+		return false;
+	m_epsilon = std::max(std::min(epsilon, m_epsilon), 1.0f);
+
+	std::vector<int> queued;
+	queued.swap(m_incons);
+	m_open.forEachNode([&](int node) {
+		queued.push_back(node);
+	});
+	m_open.clear();
+	for (int node : queued) {
+		m_inconsistent[node] = 0;
+		m_open.push(node, fValue(node), m_g[node]);
+	}
+	m_pass++;
+
+	improvePath();
+	return finishPass(path, bound);
+}
+
+// ----------------------------------------------------------------
+//  Name:           improvePath
+//  Description:    The weighted A* loop. Stops once no open node
+//                  could still give the destination a lower
+//                  weighted cost. A node already closed in this
+//                  pass is not reopened when its cost drops; it
+//                  goes on the incons list instead.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void AnytimeAStar<NodeType, ArcType>::improvePath() {
+	while (m_open.empty() == false && (m_g[m_dest] == INFINITE_COST || fValue(m_dest) > m_open.topCost())) {
+		int current = m_open.pop();
+		m_closed[current] = m_pass;
+		m_expanded++;
+
+		NodeType currentG = m_g[current];
+		m_graph.forEachArc(current, [&](int child, ArcType weight) {
+			NodeType Gc = currentG + weight;
+			if (Gc >= m_g[child])
+				return;
+			m_g[child] = Gc;
+			m_previous[child] = current;
+			if (m_closed[child] != m_pass) {
+				m_open.push(child, fValue(child), Gc);
+			}
+			else if (m_inconsistent[child] == 0) {
+				m_inconsistent[child] = 1;
+				m_incons.push_back(child);
+			}
+		});
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           finishPass
+//  Description:    Works out the bound of the pass just run and
+//                  writes its path. No node left on the open or
+//                  incons lists can lead to a path cheaper than its
+//                  g + h, so the lowest of those over the path's
+//                  cost bounds it, often tighter than e.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool AnytimeAStar<NodeType, ArcType>::finishPass(std::vector<int>& path, float& bound) {
+	if (m_g[m_dest] == INFINITE_COST)
+		return false;
+
+	double lowest = (double)m_g[m_dest];
+	auto lower = [&](int node) {
+		double estimate = (double)m_g[node] + (double)heuristic(node);
+		if (estimate < lowest)
+			lowest = estimate;
+	};
+	m_open.forEachNode(lower);
+	for (int node : m_incons)
+		lower(node);
+	m_bound = m_epsilon;
+	if (m_g[m_dest] == NodeType())
+		m_bound = 1;
+	else if (lowest > 0 && (double)m_g[m_dest] / lowest < m_bound)
+		m_bound = (float)((double)m_g[m_dest] / lowest);
+	if (m_bound < 1)
+		m_bound = 1;
+	bound = m_bound;
+
+	path.clear();
+	for (int node = m_dest; node != -1; node = m_previous[node])
+		path.push_back(node);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+#endif
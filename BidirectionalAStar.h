@@ -0,0 +1,158 @@
+#ifndef BIDIRECTIONALASTAR_H
+#define BIDIRECTIONALASTAR_H
+
+#include <vector>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+
+// ----------------------------------------------------------------
+//  Name:           BidirectionalContext
+//  Description:    Search state for a bidirectional search: one
+//                  context for the forward half and one for the
+//                  backward half.
+// ----------------------------------------------------------------
+template<class NodeType, class OpenList = typename DefaultOpenList<NodeType>::type>
+struct BidirectionalContext {
+	SearchContext<NodeType, OpenList> forward;
+	SearchContext<NodeType, OpenList> backward;
+};
+
+// ----------------------------------------------------------------
+//  Name:           BidirectionalAStar
+//  Description:    A* run forwards from the start and backwards
+//                  (over the reversed arcs) from the destination at
+//                  the same time, so each half only has to cover
+//                  about half the distance.
+//
+//                  Both halves use the balanced potentials
+//                      pf(v) = (ht(v) - hs(v)) / 2,  pr(v) = -pf(v)
+//                  where ht estimates v to dest and hs start to v.
+//                  Keys are kept doubled (2g + ht - hs) so integer
+//                  costs stay exact. Because pf + pr = 0 the search
+//                  can stop as soon as the two smallest keys add up
+//                  to twice the best path found so far.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class BidirectionalAStar {
+private:
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+public:
+	BidirectionalAStar(const GraphCSR<NodeType, ArcType>& graph) : m_graph(graph) {}
+
+	template<class OpenList>
+	bool aStar(int start, int dest, std::vector<int>& path, BidirectionalContext<NodeType, OpenList>& context) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    Bidirectional A* search. Same inputs and output
+//                  as GraphCSR::aStar.
+//  Arguments:      The start and destination node indices, the
+//                  vector the path (start to dest) is written to and
+//                  the search context, which is reset first.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool BidirectionalAStar<NodeType, ArcType>::aStar(int start, int dest, std::vector<int>& path, BidirectionalContext<NodeType, OpenList>& context) const {
+	typedef SearchContext<NodeType, OpenList> Context;
+
+	int count = m_graph.nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+
+	Context* halves[2] = { &context.forward, &context.backward };
+	for (int side = 0; side < 2; side++) {
+		if (halves[side]->size() < count)
+			halves[side]->resize(count);
+		halves[side]->reset();
+	}
+
+	if (start == dest) {
+		path.assign(1, start);
+		return true;
+	}
+
+	// hCost holds each node's potential difference for its side
+	Context& forward = context.forward;
+	Context& backward = context.backward;
+	NodeType potential = m_graph.heuristic(start, dest);
+	forward.setState(start, Context::OPEN);
+	forward.setGCost(start, NodeType());
+	forward.setHCost(start, potential);
+	forward.openList().push(start, potential, NodeType());
+	backward.setState(dest, Context::OPEN);
+	backward.setGCost(dest, NodeType());
+	backward.setHCost(dest, potential);
+	backward.openList().push(dest, potential, NodeType());
+
+	NodeType best = NodeType();
+	int meeting = -1;
+
+	while (forward.openList().empty() == false && backward.openList().empty() == false) {
+		NodeType topForward = forward.openList().topCost();
+		NodeType topBackward = backward.openList().topCost();
+		if (meeting != -1 && topForward + topBackward >= best + best)
+			break;
+
+		// expand whichever half has the smaller key
+		int side = (topForward <= topBackward) ? 0 : 1;
+		Context& current = *halves[side];
+		Context& other = *halves[1 - side];
+
+		int node = current.openList().pop();
+		if (current.state(node) == Context::CLOSED)
+			continue;
+		current.setState(node, Context::CLOSED);
+		NodeType nodeG = current.gCost(node);
+
+		auto relax = [&](int child, ArcType weight) {
+			if (current.state(child) == Context::CLOSED)
+				return;
+			NodeType Gc = nodeG + weight;
+			if (current.state(child) == Context::UNVISITED) {
+				NodeType toDest = m_graph.heuristic(child, dest);
+				NodeType fromStart = m_graph.heuristic(start, child);
+				current.setHCost(child, side == 0 ? toDest - fromStart : fromStart - toDest);
+			}
+			else if (Gc >= current.gCost(child)) {
+				return;
+			}
+			current.setState(child, Context::OPEN);
+			current.setGCost(child, Gc);
+			current.setPrevious(child, node);
+			current.openList().push(child, Gc + Gc + current.hCost(child), Gc);
+
+			// the other half has reached this node too: a full path
+			if (other.state(child) != Context::UNVISITED) {
+				NodeType length = Gc + other.gCost(child);
+				if (meeting == -1 || length < best) {
+					best = length;
+					meeting = child;
+				}
+			}
+		};
+
+		if (side == 0)
+			m_graph.forEachArc(node, relax);
+		else
+			m_graph.forEachReverseArc(node, relax);
+	}
+
+	if (meeting == -1)
+		return false;
+
+	// start to the meeting node from the forward half, then on to
+	// dest from the backward half
+	path.clear();
+	for (int node = meeting; node != -1; node = forward.previous(node))
+		path.push_back(node);
+	std::reverse(path.begin(), path.end());
+	for (int node = backward.previous(meeting); node != -1; node = backward.previous(node))
+		path.push_back(node);
+	return true;
+}
+
+#endif
@@ -0,0 +1,382 @@
+#ifndef COMPRESSEDPATHDATABASE_H
+#define COMPRESSEDPATHDATABASE_H
+
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+#include "ParallelFor.h"
+
+// ----------------------------------------------------------------
+//  Name:           CompressedPathDatabase
+//  Description:    A compressed path database (CPD): for every
+//                  source node, the first move of a shortest path
+//                  to every target. A move is the position of the
+//                  arc among its source's arcs. A path is read off
+//                  by taking the first move towards the target
+//                  from each node in turn, with no search.
+//
+//                  A full table is n * n moves. Here the targets
+//                  of each row are put in depth first order, where
+//                  nearby nodes sit next to each other and mostly
+//                  share a first move, and the row is stored as
+//                  runs of (first position, move). A lookup is one
+//                  binary search over the source's runs.
+//
+//                  build() runs one Dijkstra per source, spread
+//                  over threads.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class CompressedPathDatabase {
+private:
+	typedef SearchContext<NodeType> Context;
+
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+// ----------------------------------------------------------------
+//  Description:    m_position[v] is v's place in the target order.
+// ----------------------------------------------------------------
+	std::vector<int> m_position;
+
+// ----------------------------------------------------------------
+//  Description:    The runs of source s are entries m_rowOffsets[s]
+//                  to m_rowOffsets[s + 1]: a run covers the target
+//                  positions from its start up to the next run's.
+// ----------------------------------------------------------------
+	std::vector<int> m_rowOffsets;
+	std::vector<int> m_runStarts;
+	std::vector<unsigned short> m_runMoves;
+
+// ----------------------------------------------------------------
+//  Description:    NO_MOVE marks targets that cannot be reached.
+//                  ANY_MOVE is the source itself, which is never
+//                  looked up, so it joins whichever run it falls in.
+// ----------------------------------------------------------------
+	static const unsigned short NO_MOVE = 0xffff;
+	static const unsigned short ANY_MOVE = 0xfffe;
+
+	struct Row {
+		std::vector<int> starts;
+		std::vector<unsigned short> moves;
+	};
+
+	void orderTargets();
+	void buildRow(int source, Context& context, std::vector<unsigned short>& firstMoves, std::vector<unsigned short>& row, Row& runs) const;
+	unsigned short move(int start, int dest) const;
+
+public:
+	CompressedPathDatabase(const GraphCSR<NodeType, ArcType>& graph) : m_graph(graph) {}
+
+	bool build(int threadCount = 0);
+	bool save(std::ostream& out) const;
+	bool load(std::istream& in);
+
+	int nextHop(int start, int dest) const;
+	bool query(int start, int dest, std::vector<int>& path) const;
+	NodeType distance(int start, int dest) const;
+
+    // Accessors
+	int runCount() const {
+		return (int)m_runStarts.size();
+	}
+};
+
+template<class NodeType, class ArcType>
+const unsigned short CompressedPathDatabase<NodeType, ArcType>::NO_MOVE;
+
+template<class NodeType, class ArcType>
+const unsigned short CompressedPathDatabase<NodeType, ArcType>::ANY_MOVE;
+
+// ----------------------------------------------------------------
+//  Name:           orderTargets
+//  Description:    Numbers the nodes in depth first preorder,
+//                  following arcs either way, one tree after
+//                  another until every node is numbered.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompressedPathDatabase<NodeType, ArcType>::orderTargets() {
+	int count = m_graph.nodeCount();
+	m_position.assign(count, -1);
+	int next = 0;
+	std::vector<int> stack;
+	for (int root = 0; root < count; root++) {
+		if (m_position[root] != -1)
+			continue;
+		stack.push_back(root);
+		while (stack.empty() == false) {
+			int node = stack.back();
+			stack.pop_back();
+			if (m_position[node] != -1)
+				continue;
+			m_position[node] = next++;
+			auto push = [&](int other, ArcType) {
+				if (m_position[other] == -1)
+					stack.push_back(other);
+			};
+			m_graph.forEachReverseArc(node, push);
+			m_graph.forEachArc(node, push);
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildRow
+//  Description:    Dijkstra from one source, carrying the first
+//                  move from the source down to every node reached,
+//                  then the moves in target order as runs.
+//  Arguments:      The source, the thread's context and scratch
+//                  vectors, and the row to fill.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompressedPathDatabase<NodeType, ArcType>::buildRow(int source, Context& context, std::vector<unsigned short>& firstMoves, std::vector<unsigned short>& row, Row& runs) const {
+	context.reset();
+	typename Context::OpenListType& open = context.openList();
+	context.setState(source, Context::OPEN);
+	context.setGCost(source, NodeType());
+	open.push(source, NodeType(), NodeType());
+
+	std::fill(row.begin(), row.end(), NO_MOVE);
+	row[m_position[source]] = ANY_MOVE;
+	while (open.empty() == false) {
+		int node = open.pop();
+		if (context.state(node) == Context::CLOSED)
+			continue;
+		context.setState(node, Context::CLOSED);
+		if (node != source)
+			row[m_position[node]] = firstMoves[node];
+
+		NodeType nodeG = context.gCost(node);
+		int begin = m_graph.arcBegin(node);
+		for (int arc = begin; arc < m_graph.arcEnd(node); arc++) {
+			int child = m_graph.target(arc);
+			NodeType Gc = nodeG + m_graph.weight(arc);
+			typename Context::NodeState state = context.state(child);
+			if (state == Context::UNVISITED || (state == Context::OPEN && Gc < context.gCost(child))) {
+				context.setState(child, Context::OPEN);
+				context.setGCost(child, Gc);
+				firstMoves[child] = node == source ? (unsigned short)(arc - begin) : firstMoves[node];
+				open.push(child, Gc, Gc);
+			}
+		}
+	}
+
+	runs.starts.clear();
+	runs.moves.clear();
+	for (int position = 0; position < (int)row.size(); position++) {
+		unsigned short move = row[position];
+		if (move == ANY_MOVE || (runs.moves.empty() == false && runs.moves.back() == move))
+			continue;
+		runs.starts.push_back(position);
+		runs.moves.push_back(move);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Orders the targets and builds every row.
+//  Arguments:      The number of threads, 0 for one per hardware
+//                  thread.
+//  Return Value:   false if some node has too many arcs for a move
+//                  to fit in 16 bits.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool CompressedPathDatabase<NodeType, ArcType>::build(int threadCount) {
+	int count = m_graph.nodeCount();
+	m_rowOffsets.assign(1, 0);
+	m_runStarts.clear();
+	m_runMoves.clear();
+	for (int node = 0; node < count; node++) {
+		if (m_graph.arcEnd(node) - m_graph.arcBegin(node) >= ANY_MOVE)
+			return false;
+	}
+	orderTargets();
+
+	struct Scratch {
+		Context context;
+		std::vector<unsigned short> firstMoves;
+		std::vector<unsigned short> row;
+	};
+	threadCount = threadCountOrDefault(threadCount);
+	std::vector<Scratch> scratch(threadCount);
+	for (Scratch& thread : scratch) {
+		thread.context.resize(count);
+		thread.firstMoves.resize(count);
+		thread.row.resize(count);
+	}
+
+	std::vector<Row> rows(count);
+	parallelFor(count, threadCount, [&](int source, int thread) {
+		Scratch& own = scratch[thread];
+		buildRow(source, own.context, own.firstMoves, own.row, rows[source]);
+	});
+
+	m_rowOffsets.resize(count + 1);
+	for (int source = 0; source < count; source++) {
+		Row& row = rows[source];
+		m_runStarts.insert(m_runStarts.end(), row.starts.begin(), row.starts.end());
+		m_runMoves.insert(m_runMoves.end(), row.moves.begin(), row.moves.end());
+		m_rowOffsets[source + 1] = (int)m_runStarts.size();
+		Row().starts.swap(row.starts);
+		Row().moves.swap(row.moves);
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           move
+//  Description:    The first move from start towards dest: the run
+//                  of start's row holding dest's position.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+unsigned short CompressedPathDatabase<NodeType, ArcType>::move(int start, int dest) const {
+	const int* begin = m_runStarts.data() + m_rowOffsets[start];
+	const int* end = m_runStarts.data() + m_rowOffsets[start + 1];
+	const int* run = std::upper_bound(begin, end, m_position[dest]);
+	if (run == begin)
+		return NO_MOVE;
+	return m_runMoves[(run - 1) - m_runStarts.data()];
+}
+
+// ----------------------------------------------------------------
+//  Name:           nextHop
+//  Description:    The node after start on a shortest path to dest.
+//  Arguments:      The start and destination node indices.
+//  Return Value:   The node, dest itself if start is dest, or -1 if
+//                  there is no path or the database is not built.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+int CompressedPathDatabase<NodeType, ArcType>::nextHop(int start, int dest) const {
+	int count = (int)m_rowOffsets.size() - 1;
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return -1;
+	if (start == dest)
+		return dest;
+	unsigned short first = move(start, dest);
+	if (first == NO_MOVE)
+		return -1;
+	return m_graph.target(m_graph.arcBegin(start) + first);
+}
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    Shortest path between two nodes, one lookup per
+//                  node on it. The snapshot must be the one the
+//                  database was built or saved from.
+//  Arguments:      The start and destination node indices and the
+//                  vector the path (start to dest) is written to.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool CompressedPathDatabase<NodeType, ArcType>::query(int start, int dest, std::vector<int>& path) const {
+	if (nextHop(start, dest) == -1)
+		return false;
+
+	path.clear();
+	path.push_back(start);
+	// the length check only guards against a database built from
+	// other arcs; moves from the right snapshot always arrive
+	int limit = (int)m_rowOffsets.size();
+	for (int node = start; node != dest; ) {
+		node = nextHop(node, dest);
+		if (node == -1 || (int)path.size() > limit)
+			return false;
+		path.push_back(node);
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           distance
+//  Description:    Shortest path cost between two nodes, the sum of
+//                  the arcs the moves take.
+//  Arguments:      The start and destination node indices.
+//  Return Value:   The cost, -1 if there is no path.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType CompressedPathDatabase<NodeType, ArcType>::distance(int start, int dest) const {
+	if (nextHop(start, dest) == -1)
+		return NodeType(-1);
+
+	NodeType cost = NodeType();
+	int steps = 0;
+	int limit = (int)m_rowOffsets.size();
+	for (int node = start; node != dest; steps++) {
+		unsigned short first = move(node, dest);
+		if (first == NO_MOVE || steps > limit)
+			return NodeType(-1);
+		int arc = m_graph.arcBegin(node) + first;
+		cost += m_graph.weight(arc);
+		node = m_graph.target(arc);
+	}
+	return cost;
+}
+
+// ----------------------------------------------------------------
+//  Name:           save
+//  Description:    Writes the database in binary so a later run can
+//                  load it instead of rebuilding.
+//  Arguments:      The stream to write to (open it in binary mode).
+//  Return Value:   true on success.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool CompressedPathDatabase<NodeType, ArcType>::save(std::ostream& out) const {
+	int header[5] = { 0x445043, (int)m_position.size(), m_graph.arcCount(), (int)m_graph.version(), runCount() };
+	out.write((const char*)header, sizeof(header));
+	if (m_position.empty() == false) {
+		out.write((const char*)&m_position[0], m_position.size() * sizeof(int));
+		out.write((const char*)&m_rowOffsets[0], m_rowOffsets.size() * sizeof(int));
+	}
+	if (m_runStarts.empty() == false) {
+		out.write((const char*)&m_runStarts[0], m_runStarts.size() * sizeof(int));
+		out.write((const char*)&m_runMoves[0], m_runMoves.size() * sizeof(unsigned short));
+	}
+	return out.good();
+}
+
+// ----------------------------------------------------------------
+//  Name:           load
+//  Description:    Reads a database written by save. Fails if it
+//                  was built for a snapshot with other node or arc
+//                  counts or another weight journal version.
+//  Arguments:      The stream to read from (open it in binary mode).
+//  Return Value:   true on success; the database is left empty on
+//                  failure.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool CompressedPathDatabase<NodeType, ArcType>::load(std::istream& in) {
+	int header[5];
+	m_position.clear();
+	m_rowOffsets.assign(1, 0);
+	m_runStarts.clear();
+	m_runMoves.clear();
+
+	in.read((char*)header, sizeof(header));
+	if (in.good() == false || header[0] != 0x445043 || header[1] != m_graph.nodeCount() || header[2] != m_graph.arcCount()
+		|| header[3] != (int)m_graph.version() || header[4] < 0)
+		return false;
+
+	m_position.resize(header[1]);
+	m_rowOffsets.resize(header[1] + 1);
+	m_runStarts.resize(header[4]);
+	m_runMoves.resize(header[4]);
+	if (header[1] > 0) {
+		in.read((char*)&m_position[0], m_position.size() * sizeof(int));
+		in.read((char*)&m_rowOffsets[0], m_rowOffsets.size() * sizeof(int));
+	}
+	if (header[4] > 0) {
+		in.read((char*)&m_runStarts[0], m_runStarts.size() * sizeof(int));
+		in.read((char*)&m_runMoves[0], m_runMoves.size() * sizeof(unsigned short));
+	}
+	if (in.good() == false || m_rowOffsets[header[1]] != header[4]) {
+		m_position.clear();
+		m_rowOffsets.assign(1, 0);
+		m_runStarts.clear();
+		m_runMoves.clear();
+		return false;
+	}
+	return true;
+}
+
+#endif
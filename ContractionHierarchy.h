@@ -0,0 +1,509 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+#include "BidirectionalAStar.h"
+
+// ----------------------------------------------------------------
+//  Name:           ContractionHierarchy
+//  Description:    Contraction Hierarchies for static graphs.
+//
+//                  build() removes ("contracts") nodes one at a
+//                  time, least important first. When a node v is
+//                  removed, a shortcut u->w is added for every path
+//                  u->v->w that was the only shortest path between
+//                  u and w. A node's rank is the order it was
+//                  removed in.
+//
+//                  Every arc, original or shortcut, is kept at its
+//                  lower ranked end. The upward graph holds the
+//                  arcs leading to higher ranks. The downward graph
+//                  holds, at each node, the arcs coming in from
+//                  higher ranks. A query searches upward from the
+//                  start and, over the downward arcs, upward from
+//                  the destination; both only ever climb in rank,
+//                  so very few nodes are visited. Shortcuts
+//                  remember the node they skip so paths can be
+//                  unpacked into original arcs.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class ContractionHierarchy {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    One side of the hierarchy in CSR form. For the
+//                  upward graph nodes[] are arc targets, for the
+//                  downward graph they are arc sources. middles[]
+//                  is the node a shortcut skips, -1 for an arc of
+//                  the original graph.
+// ----------------------------------------------------------------
+	struct Adjacency {
+		std::vector<int> offsets;
+		std::vector<int> nodes;
+		std::vector<NodeType> weights;
+		std::vector<int> middles;
+	};
+
+// ----------------------------------------------------------------
+//  Description:    An arc of the graph while it is being contracted.
+// ----------------------------------------------------------------
+	struct WorkArc {
+		int node;
+		NodeType weight;
+		int middle;
+
+		WorkArc(int n, NodeType w, int m) : node(n), weight(w), middle(m) {}
+	};
+
+	typedef std::vector<std::vector<WorkArc> > WorkGraph;
+
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+	std::vector<int> m_rank;
+	Adjacency m_up;
+	Adjacency m_down;
+	int m_shortcutCount;
+
+// ----------------------------------------------------------------
+//  Description:    Witness searches give up after settling this
+//                  many nodes. A missed witness only costs an extra
+//                  shortcut, never a wrong answer.
+// ----------------------------------------------------------------
+	static const int WITNESS_SETTLE_LIMIT = 100;
+
+	void witnessSearch(const WorkGraph& out, int source, int skip, NodeType limit, SearchContext<NodeType>& context) const;
+	int contract(WorkGraph& out, WorkGraph& in, int node, bool apply, SearchContext<NodeType>& context);
+	static void setArc(std::vector<WorkArc>& arcs, int node, NodeType weight, int middle);
+	static void removeArc(std::vector<WorkArc>& arcs, int node);
+	static void compress(const std::vector<std::vector<WorkArc> >& lists, Adjacency& adjacency);
+	bool findArc(int from, int to, int& middle) const;
+	void unpack(int from, int to, std::vector<int>& path) const;
+
+public:
+	ContractionHierarchy(const GraphCSR<NodeType, ArcType>& graph);
+
+	void build();
+
+	template<class OpenList>
+	bool query(int start, int dest, std::vector<int>& path, BidirectionalContext<NodeType, OpenList>& context) const;
+
+    // Accessors
+	int rank(int node) const {
+		return m_rank[node];
+	}
+
+	int shortcutCount() const {
+		return m_shortcutCount;
+	}
+
+	int nodeCount() const {
+		return (int)m_rank.size();
+	}
+
+// ----------------------------------------------------------------
+//  Name:           forEachUpArc / forEachDownArc
+//  Description:    Calls visit(node, weight) for every upward arc
+//                  leaving a node, or every downward arc entering
+//                  it (node is then the arc's source).
+// ----------------------------------------------------------------
+	template<class Visitor>
+	void forEachUpArc(int node, Visitor visit) const {
+		for (int arc = m_up.offsets[node]; arc < m_up.offsets[node + 1]; arc++)
+			visit(m_up.nodes[arc], m_up.weights[arc]);
+	}
+
+	template<class Visitor>
+	void forEachDownArc(int node, Visitor visit) const {
+		for (int arc = m_down.offsets[node]; arc < m_down.offsets[node + 1]; arc++)
+			visit(m_down.nodes[arc], m_down.weights[arc]);
+	}
+
+	void unpackPath(const std::vector<int>& hierarchyPath, std::vector<int>& path) const;
+};
+
+template<class NodeType, class ArcType>
+ContractionHierarchy<NodeType, ArcType>::ContractionHierarchy(const GraphCSR<NodeType, ArcType>& graph) :
+m_graph(graph),
+m_shortcutCount(0) {
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Orders and contracts every node. The next node
+//                  to contract is the one with the lowest
+//                      edge difference + contracted neighbours
+//                  where edge difference is the shortcuts it would
+//                  add minus the arcs it would remove. Priorities
+//                  are updated lazily: a popped node is re-scored
+//                  and put back if it is no longer the lowest.
+//                  (Re-scoring every neighbour after each
+//                  contraction was tried; on grids it made the
+//                  build several times slower for no fewer
+//                  shortcuts.)
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void ContractionHierarchy<NodeType, ArcType>::build() {
+	typedef std::pair<int, int> Candidate;
+
+	int count = m_graph.nodeCount();
+	WorkGraph out(count);
+	WorkGraph in(count);
+	for (int node = 0; node < count; node++) {
+		m_graph.forEachArc(node, [&](int target, ArcType weight) {
+			if (target != node) {
+				setArc(out[node], target, (NodeType)weight, -1);
+				setArc(in[target], node, (NodeType)weight, -1);
+			}
+		});
+	}
+
+	// upward and downward arcs of every node, kept as it is contracted
+	WorkGraph up(count);
+	WorkGraph down(count);
+	std::vector<int> contractedNeighbours(count, 0);
+	m_rank.assign(count, -1);
+	m_shortcutCount = 0;
+
+	// every node is queued exactly once at any time
+	SearchContext<NodeType> context(count);
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > queue;
+	for (int node = 0; node < count; node++)
+		queue.push(Candidate(contract(out, in, node, false, context), node));
+
+	std::vector<int> neighbours;
+	int order = 0;
+	while (queue.empty() == false) {
+		int node = queue.top().second;
+		queue.pop();
+
+		int priority = contract(out, in, node, false, context) + contractedNeighbours[node];
+		if (queue.empty() == false && priority > queue.top().first) {
+			queue.push(Candidate(priority, node));
+			continue;
+		}
+
+		// what is left around the node now links it to higher ranks
+		up[node] = out[node];
+		down[node] = in[node];
+		m_shortcutCount += contract(out, in, node, true, context);
+		m_rank[node] = order++;
+
+		neighbours.clear();
+		for (const WorkArc& arc : out[node]) {
+			removeArc(in[arc.node], node);
+			neighbours.push_back(arc.node);
+		}
+		for (const WorkArc& arc : in[node]) {
+			removeArc(out[arc.node], node);
+			neighbours.push_back(arc.node);
+		}
+		out[node].clear();
+		in[node].clear();
+
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+		for (int neighbour : neighbours)
+			contractedNeighbours[neighbour]++;
+	}
+
+	compress(up, m_up);
+	compress(down, m_down);
+}
+
+// ----------------------------------------------------------------
+//  Name:           contract
+//  Description:    Works out the shortcuts needed to remove a node:
+//                  one for each in-arc u->node and out-arc node->w
+//                  with no witness path u->w (avoiding the node)
+//                  that is as short.
+//  Arguments:      The working graph, the node, true to add the
+//                  shortcuts or false to only count them, and a
+//                  context for the witness searches.
+//  Return Value:   When counting, the edge difference (shortcuts
+//                  minus removed arcs); when applying, the number
+//                  of shortcuts added.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+int ContractionHierarchy<NodeType, ArcType>::contract(WorkGraph& out, WorkGraph& in, int node, bool apply, SearchContext<NodeType>& context) {
+	int shortcuts = 0;
+	std::vector<WorkArc> incoming = in[node];
+	const std::vector<WorkArc>& outgoing = out[node];
+
+	for (const WorkArc& first : incoming) {
+		NodeType limit = NodeType();
+		for (const WorkArc& second : outgoing) {
+			if (first.weight + second.weight > limit)
+				limit = first.weight + second.weight;
+		}
+		witnessSearch(out, first.node, node, limit, context);
+
+		for (const WorkArc& second : outgoing) {
+			if (second.node == first.node)
+				continue;
+			NodeType through = first.weight + second.weight;
+			if (context.state(second.node) != SearchContext<NodeType>::UNVISITED && context.gCost(second.node) <= through)
+				continue;
+			shortcuts++;
+			if (apply) {
+				setArc(out[first.node], second.node, through, node);
+				setArc(in[second.node], first.node, through, node);
+			}
+		}
+	}
+
+	if (apply)
+		return shortcuts;
+	return shortcuts - (int)(incoming.size() + outgoing.size());
+}
+
+// ----------------------------------------------------------------
+//  Name:           witnessSearch
+//  Description:    Dijkstra from source that skips one node and
+//                  stops past a cost limit or the settle limit.
+//                  Results are left in the context.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void ContractionHierarchy<NodeType, ArcType>::witnessSearch(const WorkGraph& out, int source, int skip, NodeType limit, SearchContext<NodeType>& context) const {
+	typedef SearchContext<NodeType> Context;
+
+	context.reset();
+	context.setState(source, Context::OPEN);
+	context.setGCost(source, NodeType());
+	context.openList().push(source, NodeType(), NodeType());
+
+	int settled = 0;
+	while (context.openList().empty() == false && settled < WITNESS_SETTLE_LIMIT) {
+		int node = context.openList().pop();
+		if (context.state(node) == Context::CLOSED)
+			continue;
+		context.setState(node, Context::CLOSED);
+		settled++;
+		NodeType nodeG = context.gCost(node);
+		if (nodeG > limit)
+			break;
+
+		for (const WorkArc& arc : out[node]) {
+			if (arc.node == skip)
+				continue;
+			NodeType Gc = nodeG + arc.weight;
+			typename Context::NodeState state = context.state(arc.node);
+			if (state == Context::UNVISITED || (state == Context::OPEN && Gc < context.gCost(arc.node))) {
+				context.setState(arc.node, Context::OPEN);
+				context.setGCost(arc.node, Gc);
+				context.openList().push(arc.node, Gc, Gc);
+			}
+		}
+	}
+}
+
+// adds an arc to a list, or lowers the weight of the one already there
+template<class NodeType, class ArcType>
+void ContractionHierarchy<NodeType, ArcType>::setArc(std::vector<WorkArc>& arcs, int node, NodeType weight, int middle) {
+	for (WorkArc& arc : arcs) {
+		if (arc.node == node) {
+			if (weight < arc.weight) {
+				arc.weight = weight;
+				arc.middle = middle;
+			}
+			return;
+		}
+	}
+	arcs.push_back(WorkArc(node, weight, middle));
+}
+
+template<class NodeType, class ArcType>
+void ContractionHierarchy<NodeType, ArcType>::removeArc(std::vector<WorkArc>& arcs, int node) {
+	for (size_t i = 0; i < arcs.size(); i++) {
+		if (arcs[i].node == node) {
+			arcs[i] = arcs.back();
+			arcs.pop_back();
+			return;
+		}
+	}
+}
+
+template<class NodeType, class ArcType>
+void ContractionHierarchy<NodeType, ArcType>::compress(const std::vector<std::vector<WorkArc> >& lists, Adjacency& adjacency) {
+	adjacency.offsets.assign(lists.size() + 1, 0);
+	adjacency.nodes.clear();
+	adjacency.weights.clear();
+	adjacency.middles.clear();
+	for (size_t node = 0; node < lists.size(); node++) {
+		for (const WorkArc& arc : lists[node]) {
+			adjacency.nodes.push_back(arc.node);
+			adjacency.weights.push_back(arc.weight);
+			adjacency.middles.push_back(arc.middle);
+		}
+		adjacency.offsets[node + 1] = (int)adjacency.nodes.size();
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    Shortest path between two nodes. Runs Dijkstra
+//                  upward from both ends and stops once neither
+//                  side can beat the best meeting point found.
+//  Arguments:      The start and destination node indices, the
+//                  vector the unpacked path (start to dest, original
+//                  arcs only) is written to and the search context,
+//                  which is reset first.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool ContractionHierarchy<NodeType, ArcType>::query(int start, int dest, std::vector<int>& path, BidirectionalContext<NodeType, OpenList>& context) const {
+	typedef SearchContext<NodeType, OpenList> Context;
+
+	int count = nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+
+	Context* halves[2] = { &context.forward, &context.backward };
+	for (int side = 0; side < 2; side++) {
+		if (halves[side]->size() < count)
+			halves[side]->resize(count);
+		halves[side]->reset();
+	}
+	const Adjacency* graphs[2] = { &m_up, &m_down };
+
+	halves[0]->setState(start, Context::OPEN);
+	halves[0]->setGCost(start, NodeType());
+	halves[0]->openList().push(start, NodeType(), NodeType());
+	halves[1]->setState(dest, Context::OPEN);
+	halves[1]->setGCost(dest, NodeType());
+	halves[1]->openList().push(dest, NodeType(), NodeType());
+
+	NodeType best = NodeType();
+	int meeting = -1;
+	for (;;) {
+		// a side is finished once it cannot improve on the best path
+		bool active[2];
+		for (int side = 0; side < 2; side++) {
+			active[side] = halves[side]->openList().empty() == false &&
+				(meeting == -1 || halves[side]->openList().topCost() < best);
+		}
+		if (active[0] == false && active[1] == false)
+			break;
+
+		int side = 0;
+		if (active[0] == false || (active[1] && halves[1]->openList().topCost() < halves[0]->openList().topCost()))
+			side = 1;
+		Context& current = *halves[side];
+		Context& other = *halves[1 - side];
+		const Adjacency& graph = *graphs[side];
+
+		int node = current.openList().pop();
+		if (current.state(node) == Context::CLOSED)
+			continue;
+		current.setState(node, Context::CLOSED);
+		NodeType nodeG = current.gCost(node);
+
+		if (other.state(node) != Context::UNVISITED) {
+			NodeType length = nodeG + other.gCost(node);
+			if (meeting == -1 || length < best) {
+				best = length;
+				meeting = node;
+			}
+		}
+
+		for (int arc = graph.offsets[node]; arc < graph.offsets[node + 1]; arc++) {
+			int child = graph.nodes[arc];
+			NodeType Gc = nodeG + graph.weights[arc];
+			typename Context::NodeState state = current.state(child);
+			if (state == Context::UNVISITED || (state == Context::OPEN && Gc < current.gCost(child))) {
+				current.setState(child, Context::OPEN);
+				current.setGCost(child, Gc);
+				current.setPrevious(child, node);
+				current.openList().push(child, Gc, Gc);
+			}
+		}
+	}
+
+	if (meeting == -1)
+		return false;
+
+	std::vector<int> hierarchyPath;
+	for (int node = meeting; node != -1; node = halves[0]->previous(node))
+		hierarchyPath.push_back(node);
+	std::reverse(hierarchyPath.begin(), hierarchyPath.end());
+	for (int node = halves[1]->previous(meeting); node != -1; node = halves[1]->previous(node))
+		hierarchyPath.push_back(node);
+
+	unpackPath(hierarchyPath, path);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           unpackPath
+//  Description:    Replaces every shortcut on a path through the
+//                  hierarchy with the original arcs it stands for.
+//  Arguments:      The hierarchy path and the vector the original
+//                  path is written to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void ContractionHierarchy<NodeType, ArcType>::unpackPath(const std::vector<int>& hierarchyPath, std::vector<int>& path) const {
+	path.clear();
+	if (hierarchyPath.empty())
+		return;
+	path.push_back(hierarchyPath[0]);
+	for (size_t i = 1; i < hierarchyPath.size(); i++)
+		unpack(hierarchyPath[i - 1], hierarchyPath[i], path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           unpack
+//  Description:    Appends the original nodes after from on the arc
+//                  from->to. Uses an explicit stack, since long
+//                  shortcuts can nest deeply.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void ContractionHierarchy<NodeType, ArcType>::unpack(int from, int to, std::vector<int>& path) const {
+	std::vector<std::pair<int, int> > stack;
+	stack.push_back(std::make_pair(from, to));
+	while (stack.empty() == false) {
+		std::pair<int, int> arc = stack.back();
+		stack.pop_back();
+		int middle = -1;
+		findArc(arc.first, arc.second, middle);
+		if (middle == -1) {
+			path.push_back(arc.second);
+		}
+		else {
+			// second half pushed first so the first half comes out first
+			stack.push_back(std::make_pair(middle, arc.second));
+			stack.push_back(std::make_pair(arc.first, middle));
+		}
+	}
+}
+
+// finds the hierarchy arc from->to, stored at its lower ranked end
+template<class NodeType, class ArcType>
+bool ContractionHierarchy<NodeType, ArcType>::findArc(int from, int to, int& middle) const {
+	if (m_rank[from] < m_rank[to]) {
+		for (int arc = m_up.offsets[from]; arc < m_up.offsets[from + 1]; arc++) {
+			if (m_up.nodes[arc] == to) {
+				middle = m_up.middles[arc];
+				return true;
+			}
+		}
+	}
+	else {
+		for (int arc = m_down.offsets[to]; arc < m_down.offsets[to + 1]; arc++) {
+			if (m_down.nodes[arc] == from) {
+				middle = m_down.middles[arc];
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+#endif
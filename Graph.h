@@ -3,6 +3,16 @@
 
 #include <list>
 #include <queue>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+#include "NodePosition.h"
+#include "GraphCSR.h"
+#include "SearchContext.h"
+#include "AStarSearch.h"
+#include "SearchResult.h"
+#include "WeightJournal.h"
 
 using namespace std;
 
@@ -12,7 +22,8 @@ template <class DataType, class NodeType, class ArcType> class GraphNode;
 // ----------------------------------------------------------------
 //  Name:           Graph
 //  Description:    This is the graph class, it contains all the
-//                  nodes.
+//                  nodes. It has no rendering dependencies; see
+//                  GraphView for the optional SFML view.
 // ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
 class Graph {
@@ -38,17 +49,16 @@ private:
 // ----------------------------------------------------------------
     int m_count;
 
-	class NodeSearchCostComparer {
-	public:
-		bool operator()(Node * n1, Node * n2) {
-			NodeType f1 = n1->hCost() + n1->gCost();
-			NodeType f2 = n2->hCost() + n2->gCost();
-			// adds H(n) and G(n) to get F(n)
-			return f1 > f2;
-		}
-	};
+// ----------------------------------------------------------------
+//  Description:    Every weight change made through updateWeights.
+// ----------------------------------------------------------------
+	WeightJournal<ArcType> m_journal;
 
-	sf::Font font;
+// ----------------------------------------------------------------
+//  Description:    Bumped by every node or arc added or removed,
+//                  so a snapshot can tell its arc layout is stale.
+// ----------------------------------------------------------------
+	unsigned int m_structureVersion;
 
 public:           
     // Constructor and destructor functions
@@ -60,20 +70,52 @@ public:
        return m_pNodes;
     }
 
+	WeightJournal<ArcType> const & journal() const {
+		return m_journal;
+	}
+
+	unsigned int structureVersion() const {
+		return m_structureVersion;
+	}
+
+	void discardJournalUpTo(unsigned int version) {
+		m_journal.discardUpTo(version);
+	}
+
     // Public member functions.
-	bool addNode(DataType data, int index, sf::Vector2f position);
+	bool addNode(DataType data, int index, NodePosition position);
     void removeNode( int index );
     bool addArc( int from, int to, ArcType weight, bool directed = true );
     void removeArc( int from, int to );
 	Arc* getArc(int from, int to);
-	void reset();
-	int getMaxNodes();
+	int getMaxNodes() const;
+	bool updateWeights(const std::vector<WeightUpdate<ArcType> >& updates);
+
+// ----------------------------------------------------------------
+//  Name:           forEachArc
+//  Description:    Calls visit(target, weight) for every arc
+//                  leaving the node at an index.
+// ----------------------------------------------------------------
+	template<class Visitor>
+	void forEachArc(int node, Visitor visit) const {
+		typename list<Arc>::const_iterator iter = m_pNodes[node]->arcList().begin();
+		typename list<Arc>::const_iterator endIter = m_pNodes[node]->arcList().end();
+		for (; iter != endIter; ++iter)
+			visit((*iter).node()->index(), (*iter).weight());
+	}
 
 	//Pathfinding Assignment
-	void aStar(Node* pStart, Node* pDest, std::vector<Node *>& path);
-	void setHeuristics(Node* pDest);
-	void drawNodes(sf::RenderTarget& target) const;
-	void drawArcs(sf::RenderTarget& target) const;
+	template<class OpenList>
+	SearchResult<NodeType> aStar(Node* pStart, Node* pDest, std::vector<Node *>& path, SearchContext<NodeType, OpenList>& context) const;
+	template<class OpenList>
+	SearchResult<NodeType> aStar(Node* pStart, Node* pDest, int* path, int capacity, SearchContext<NodeType, OpenList>& context) const;
+	template<class OpenList>
+	SearchResult<NodeType> distance(Node* pStart, Node* pDest, SearchContext<NodeType, OpenList>& context) const;
+	template<class OpenList>
+	void setHeuristics(Node* pDest, SearchContext<NodeType, OpenList>& context) const;
+	NodeType heuristic(int node, int dest) const;
+	GraphCSR<NodeType, ArcType> freeze() const;
+	void nodePath(const std::vector<int>& indices, std::vector<Node *>& path) const;
 
 };
 
@@ -84,7 +126,7 @@ public:
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-Graph<DataType, NodeType, ArcType>::Graph(int size) : m_maxNodes(size) {
+Graph<DataType, NodeType, ArcType>::Graph(int size) : m_maxNodes(size), m_structureVersion(0) {
    int i;
    m_pNodes = new Node * [m_maxNodes];
    // go through every index and clear it to null (0)
@@ -94,8 +136,6 @@ Graph<DataType, NodeType, ArcType>::Graph(int size) : m_maxNodes(size) {
 
    // set the node count to 0.
    m_count = 0;
-
-   font.loadFromFile("assets/GARA.TTF");
 }
 
 // ----------------------------------------------------------------
@@ -113,7 +153,7 @@ Graph<DataType, NodeType, ArcType>::~Graph() {
         }
    }
    // Delete the actual array
-   delete m_pNodes;
+   delete [] m_pNodes;
 }
 
 // ----------------------------------------------------------------
@@ -124,20 +164,20 @@ Graph<DataType, NodeType, ArcType>::~Graph() {
 //  Return Value:   true if successful
 // ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-bool Graph<DataType, NodeType, ArcType>::addNode(DataType data, int index, sf::Vector2f position) {
+bool Graph<DataType, NodeType, ArcType>::addNode(DataType data, int index, NodePosition position) {
    bool nodeNotPresent = false;
    // find out if a node does not exist at that index.
    if ( m_pNodes[index] == 0) {
       nodeNotPresent = true;
-      // create a new node, put the data in it, and unmark it.
-	  m_pNodes[index] = new Node(font);
+      // create a new node and put the data in it.
+	  m_pNodes[index] = new Node();
 	  m_pNodes[index]->setData(data);
-      m_pNodes[index]->setMarked(false);
+	  m_pNodes[index]->setIndex(index);
 	  m_pNodes[index]->setPosition(position);
-	  m_pNodes[index]->setColour(sf::Color::Blue);
 
       // increase the count and return success.
       m_count++;
+      m_structureVersion++;
     }
         
     return nodeNotPresent;
@@ -156,10 +196,11 @@ void Graph<DataType, NodeType, ArcType>::removeNode(int index) {
          // now find every arc that points to the node that
          // is being removed and remove it.
          int node;
-         Arc* arc;
+         Arc* arc = 0;
 
          // loop through every node
          for( node = 0; node < m_maxNodes; node++ ) {
+              arc = 0;
               // if the node is valid...
               if( m_pNodes[node] != 0 ) {
                   // see if the node has an arc pointing to the current node.
@@ -178,6 +219,7 @@ void Graph<DataType, NodeType, ArcType>::removeNode(int index) {
         delete m_pNodes[index];
         m_pNodes[index] = 0;
         m_count--;
+        m_structureVersion++;
     }
 }
 
@@ -199,7 +241,7 @@ bool Graph<DataType, NodeType, ArcType>::addArc(int from, int to, ArcType weight
      }
         
      // if an arc already exists we should not proceed
-     if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
+     else if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
          proceed = false;
      }
 
@@ -208,6 +250,7 @@ bool Graph<DataType, NodeType, ArcType>::addArc(int from, int to, ArcType weight
 		 m_pNodes[from]->addArc(m_pNodes[to], weight);
 		 if (directed == false) //add node back the other way if undirected
 			 m_pNodes[to]->addArc(m_pNodes[from], weight);
+		 m_structureVersion++;
      }
         
      return proceed;
@@ -232,6 +275,7 @@ void Graph<DataType, NodeType, ArcType>::removeArc(int from, int to) {
      if (nodeExists == true) {
         // remove the arc.
         m_pNodes[from]->removeArc( m_pNodes[to] );
+        m_structureVersion++;
      }
 }
 
@@ -256,6 +300,50 @@ GraphArc<DataType, NodeType, ArcType>* Graph<DataType, NodeType, ArcType>::getAr
      return pArc;
 }
 
+// ----------------------------------------------------------------
+//  Name:           updateWeights
+//  Description:    Changes the weights of a batch of arcs and
+//                  records every change in the journal under one
+//                  new version. Snapshots and planners built from
+//                  the graph are not touched; they catch up from
+//                  the journal when it suits them (see
+//                  GraphCSR::applyChanges).
+//  Arguments:      The changes, by arc end points.
+//  Return Value:   false, with nothing changed, if any of the arcs
+//                  does not exist.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+bool Graph<DataType, NodeType, ArcType>::updateWeights(const std::vector<WeightUpdate<ArcType> >& updates) {
+	std::vector<Arc*> arcs(updates.size());
+	std::vector<int> positions(updates.size());
+	for (size_t i = 0; i < updates.size(); i++) {
+		int from = updates[i].from;
+		int to = updates[i].to;
+		if (from < 0 || from >= m_maxNodes || to < 0 || to >= m_maxNodes || m_pNodes[from] == 0 || m_pNodes[to] == 0)
+			return false;
+		arcs[i] = m_pNodes[from]->getArc(m_pNodes[to], positions[i]);
+		if (arcs[i] == 0)
+			return false;
+	}
+
+	// the arc id is its index in a snapshot: the arcs of the nodes
+	// before it, then its place in its own node's list
+	std::vector<int> offsets(m_maxNodes + 1, 0);
+	for (int i = 0; i < m_maxNodes; i++) {
+		offsets[i + 1] = offsets[i];
+		if (m_pNodes[i] != 0)
+			offsets[i + 1] += (int)m_pNodes[i]->arcList().size();
+	}
+
+	m_journal.beginBatch();
+	for (size_t i = 0; i < updates.size(); i++) {
+		const WeightUpdate<ArcType>& update = updates[i];
+		m_journal.record(offsets[update.from] + positions[i], update.from, update.to, arcs[i]->weight(), update.weight);
+		arcs[i]->setWeight(update.weight);
+	}
+	return true;
+}
+
 // ----------------------------------------------------------------
 //  Name:           getMaxNodes
 //  Description:    Gets the number of elements in the list of nodes.
@@ -263,7 +351,7 @@ GraphArc<DataType, NodeType, ArcType>* Graph<DataType, NodeType, ArcType>::getAr
 //  Return Value:   m_maxNodes
 // ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-int Graph<DataType, NodeType, ArcType>::getMaxNodes() {
+int Graph<DataType, NodeType, ArcType>::getMaxNodes() const {
 
 	return m_maxNodes;
 }
@@ -271,100 +359,173 @@ int Graph<DataType, NodeType, ArcType>::getMaxNodes() {
 
 
 // ----------------------------------------------------------------
-//  Name:           clearMarks
-//  Description:    This clears every mark on every node.
-//  Arguments:      None.
-//  Return Value:   None.
+//  Name:           aStar
+//  Description:    A* search from one node to another. All search
+//                  state is written to the context, never to the
+//                  nodes, so several searches can run at once. The
+//                  context's OpenList parameter picks the queue.
+//  Arguments:      The start and destination nodes, the vector the
+//                  path (start to dest) is written to and the
+//                  search context, which is reset first.
+//  Return Value:   The status and cost of the path; length is the
+//                  number of nodes on it.
 // ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-void Graph<DataType, NodeType, ArcType>::reset() {
-	int index;
-	for (index = 0; index < m_maxNodes; index++) {
-		if (m_pNodes[index] != 0) {
-			m_pNodes[index]->reset();
+template<class OpenList>
+SearchResult<NodeType> Graph<DataType, NodeType, ArcType>::aStar(Node* pStart, Node* pDest, std::vector<Node *>& path, SearchContext<NodeType, OpenList>& context) const {
+	SearchResult<NodeType> result = distance(pStart, pDest, context);
+	if (result.found()) {
+		path.clear();
+		for (int previous = pDest->index(); previous != -1; previous = context.previous(previous)){
+			path.push_back(m_pNodes[previous]);
 		}
+		std::reverse(path.begin(), path.end());
+		result.length = (int)path.size();
 	}
+	return result;
 }
 
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search that writes node indices into the
+//                  caller's buffer instead of a vector of nodes, so
+//                  steady state queries do not allocate.
+//  Arguments:      The start and destination nodes, the buffer and
+//                  its capacity in nodes, and the search context,
+//                  which is reset first.
+//  Return Value:   The status and cost; length is the number of
+//                  indices written, or the capacity needed if the
+//                  buffer was too small (nothing is written then).
+// ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-void Graph<DataType, NodeType, ArcType>::aStar(Node* pStart, Node* pDest, std::vector<Node *>& path){
-	if (pStart != 0 && pDest != 0) {
-		priority_queue<Node*, vector<Node*>, NodeSearchCostComparer> pq;
-		pq.push(pStart);
-		pStart->setMarked(true);
-		pStart->setHCost(NodeType());
-		pStart->setGCost(NodeType());
-
-		while (pq.size() != 0 && pq.top() != pDest) {
-			list<Arc>::const_iterator iter = pq.top()->arcList().begin();
-			list<Arc>::const_iterator endIter = pq.top()->arcList().end();
-
-			for (; iter != endIter; iter++) {
-				Node* child = (*iter).node();
-				if (child != pq.top()->getPrevious()){
-					Arc arc = (*iter);
-					//Sleep(1000);
-					int Hc = child->hCost();
-					int Gc = pq.top()->gCost() + arc.weight();
-					int Fc = Hc + Gc;
-					if (Fc < child->fCost() || child->gCost() == -1){  //is G(n) not set, H(n) should be always set with setHeuristics()
-						child->setHCost(Hc);
-						child->setGCost(Gc);
-						child->setPrevious(pq.top());
-					}
-
-					if (child->marked() == false) {
-						pq.push(child);
-						child->setMarked(true);
-						child->setColour(sf::Color(0, 128, 128, 255));
-					}
-				}
-			}
-			pq.pop();
-		}
-
-		if (pq.size() != 0 && pq.top() == pDest){
-			for (Node* previous = pDest; previous->getPrevious() != 0; previous = previous->getPrevious()){
-				path.push_back(previous);
-				previous->setColour(sf::Color::Magenta);
-			}
-			path.push_back(pStart);
-			std::reverse(path.begin(), path.end());
-		}
-		else if (pq.size() == 0)
-			cout << "Couldn't find path." << endl;
+template<class OpenList>
+SearchResult<NodeType> Graph<DataType, NodeType, ArcType>::aStar(Node* pStart, Node* pDest, int* path, int capacity, SearchContext<NodeType, OpenList>& context) const {
+	typedef SearchResult<NodeType> Result;
+	Result result = distance(pStart, pDest, context);
+	if (result.found()) {
+		result.length = writePath(context, pDest->index(), path, capacity);
+		if (result.length > capacity)
+			result.status = Result::BUFFER_TOO_SMALL;
 	}
+	return result;
 }
 
+// ----------------------------------------------------------------
+//  Name:           distance
+//  Description:    A* search for the cost alone; no path is built.
+//  Arguments:      The start and destination nodes and the search
+//                  context, which is reset first, as GraphCSR does;
+//                  heuristics stored by setHeuristics go with it and
+//                  are worked out again as nodes are reached.
+//  Return Value:   The status and cost.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+template<class OpenList>
+SearchResult<NodeType> Graph<DataType, NodeType, ArcType>::distance(Node* pStart, Node* pDest, SearchContext<NodeType, OpenList>& context) const {
+	typedef SearchResult<NodeType> Result;
+	if (pStart == 0 || pDest == 0)
+		return Result(Result::INVALID_NODE, NodeType(-1), 0);
+	if (context.size() < m_maxNodes)
+		context.resize(m_maxNodes);
+	context.reset();
+
+	int dest = pDest->index();
+	context.setHCost(dest, NodeType());
+	if (aStarSearch(*this, pStart->index(), dest, context) == false)
+		return Result(Result::NO_PATH, NodeType(-1), 0);
+	return Result(Result::FOUND, context.gCost(dest), 0);
+}
 
-
+// ----------------------------------------------------------------
+//  Name:           setHeuristics
+//  Description:    Stores the straight line estimate to the
+//                  destination of every node in the context. The
+//                  search works these out itself as it reaches
+//                  nodes; this fills them all in up front, e.g. so
+//                  they can be displayed.
+//  Arguments:      The destination node and the search context.
+//  Return Value:   None.
+// ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-void Graph<DataType, NodeType, ArcType>::setHeuristics(Node* pDest){
+template<class OpenList>
+void Graph<DataType, NodeType, ArcType>::setHeuristics(Node* pDest, SearchContext<NodeType, OpenList>& context) const {
 	if (pDest != 0) {
-		for (int i = 0; i < m_count; i++){
-			sf::Vector2f vectorTo = pDest->getPosition() - m_pNodes[i]->getPosition();
-			int Hc = (int)(sqrt((vectorTo.x * vectorTo.x) + (vectorTo.y * vectorTo.y)));
-			m_pNodes[i]->setHCost(Hc);
+		if (context.size() < m_maxNodes)
+			context.resize(m_maxNodes);
+
+		for (int i = 0; i < m_maxNodes; i++){
+			if (m_pNodes[i] != 0) {
+				context.setHCost(i, heuristic(i, pDest->index()));
+			}
 		}
 	}
 }
 
+// ----------------------------------------------------------------
+//  Name:           heuristic
+//  Description:    Straight line distance between two nodes.
+//  Arguments:      The node and destination node indices.
+//  Return Value:   The estimated cost.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+NodeType Graph<DataType, NodeType, ArcType>::heuristic(int node, int dest) const {
+	float dx = m_pNodes[dest]->getPosition().x - m_pNodes[node]->getPosition().x;
+	float dy = m_pNodes[dest]->getPosition().y - m_pNodes[node]->getPosition().y;
+	return (NodeType)(sqrt((dx * dx) + (dy * dy)));
+}
 
-
-//draw the nodes
+// ----------------------------------------------------------------
+//  Name:           freeze
+//  Description:    Builds an immutable CSR snapshot of the graph
+//                  for fast searching. Later changes to the graph
+//                  are not reflected in the snapshot.
+//  Arguments:      None.
+//  Return Value:   The snapshot, indexed by the graph's node slots.
+// ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-void Graph<DataType, NodeType, ArcType>::drawNodes(sf::RenderTarget& target) const{
-	for (int i = 0; i < m_count; i++){
-		target.draw(m_pNodes[i]->getShape());
-		m_pNodes[i]->drawText(target);
+GraphCSR<NodeType, ArcType> Graph<DataType, NodeType, ArcType>::freeze() const {
+	std::vector<int> offsets(m_maxNodes + 1, 0);
+	std::vector<NodePosition> positions(m_maxNodes);
+
+	// count the arcs of every node, then turn the counts into offsets
+	for (int i = 0; i < m_maxNodes; i++) {
+		offsets[i + 1] = offsets[i];
+		if (m_pNodes[i] != 0) {
+			offsets[i + 1] += (int)m_pNodes[i]->arcList().size();
+			positions[i] = m_pNodes[i]->getPosition();
+		}
 	}
+
+	std::vector<int> targets(offsets[m_maxNodes]);
+	std::vector<ArcType> weights(offsets[m_maxNodes]);
+	for (int i = 0; i < m_maxNodes; i++) {
+		if (m_pNodes[i] != 0) {
+			int arc = offsets[i];
+			typename list<Arc>::const_iterator iter = m_pNodes[i]->arcList().begin();
+			typename list<Arc>::const_iterator endIter = m_pNodes[i]->arcList().end();
+			for (; iter != endIter; ++iter, ++arc) {
+				targets[arc] = (*iter).node()->index();
+				weights[arc] = (*iter).weight();
+			}
+		}
+	}
+
+	return GraphCSR<NodeType, ArcType>(offsets, targets, weights, positions, m_journal.version(), m_structureVersion);
 }
 
-//draw arcs
+// ----------------------------------------------------------------
+//  Name:           nodePath
+//  Description:    Turns a path of node indices, as returned by the
+//                  searches over a frozen snapshot, into the node
+//                  pointers aStar would have written.
+//  Arguments:      The index path and the vector the nodes are
+//                  appended to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
 template<class DataType, class NodeType, class ArcType>
-void Graph<DataType, NodeType, ArcType>::drawArcs(sf::RenderTarget& target) const{
-	for (int i = 0; i < m_count; i++)
-		m_pNodes[i]->drawArcs(target);
+void Graph<DataType, NodeType, ArcType>::nodePath(const std::vector<int>& indices, std::vector<Node *>& path) const {
+	for (size_t i = 0; i < indices.size(); i++)
+		path.push_back(m_pNodes[indices[i]]);
 }
 
 
@@ -0,0 +1,353 @@
+#ifndef GRAPHCSR_H
+#define GRAPHCSR_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "NodePosition.h"
+#include "SearchContext.h"
+#include "AStarSearch.h"
+#include "SearchResult.h"
+#include "WeightJournal.h"
+
+// ----------------------------------------------------------------
+//  Name:           GraphCSR
+//  Description:    An immutable snapshot of a Graph stored in
+//                  compressed sparse row form. The arcs leaving
+//                  node n are targets/weights in the range
+//                  [offsets[n], offsets[n + 1]), so a search walks
+//                  flat arrays instead of chasing node and list
+//                  pointers. Node indices match the graph's slots.
+//                  The arcs are also stored reversed (grouped by
+//                  target) for searches that run backwards.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class GraphCSR {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    Index of the first arc of every node, plus one
+//                  trailing entry holding the arc count.
+// ----------------------------------------------------------------
+	std::vector<int> m_offsets;
+
+// ----------------------------------------------------------------
+//  Description:    Target node and weight of every arc.
+// ----------------------------------------------------------------
+	std::vector<int> m_targets;
+	std::vector<ArcType> m_weights;
+
+// ----------------------------------------------------------------
+//  Description:    The same arcs grouped by target node: the arcs
+//                  entering node n are sources/weights in the range
+//                  [reverseOffsets[n], reverseOffsets[n + 1]).
+// ----------------------------------------------------------------
+	std::vector<int> m_reverseOffsets;
+	std::vector<int> m_reverseSources;
+	std::vector<ArcType> m_reverseWeights;
+
+// ----------------------------------------------------------------
+//  Description:    Where each arc sits in the reversed arrays, so a
+//                  weight change can update both copies.
+// ----------------------------------------------------------------
+	std::vector<int> m_reverseArcs;
+
+// ----------------------------------------------------------------
+//  Description:    Node positions, used by the heuristic.
+// ----------------------------------------------------------------
+	std::vector<NodePosition> m_positions;
+
+// ----------------------------------------------------------------
+//  Description:    The weight journal version the weights match,
+//                  and the graph's structure version the arc
+//                  layout matches.
+// ----------------------------------------------------------------
+	unsigned int m_version;
+	unsigned int m_structureVersion;
+
+public:
+	GraphCSR();
+	GraphCSR(std::vector<int>& offsets, std::vector<int>& targets,
+		std::vector<ArcType>& weights, std::vector<NodePosition>& positions,
+		unsigned int version = 0, unsigned int structureVersion = 0);
+
+    // Accessors
+	int nodeCount() const {
+		return (int)m_positions.size();
+	}
+
+	int arcCount() const {
+		return (int)m_targets.size();
+	}
+
+	int arcBegin(int node) const {
+		return m_offsets[node];
+	}
+
+	int arcEnd(int node) const {
+		return m_offsets[node + 1];
+	}
+
+	int target(int arc) const {
+		return m_targets[arc];
+	}
+
+	ArcType weight(int arc) const {
+		return m_weights[arc];
+	}
+
+	unsigned int version() const {
+		return m_version;
+	}
+
+	unsigned int structureVersion() const {
+		return m_structureVersion;
+	}
+
+	NodePosition const & position(int node) const {
+		return m_positions[node];
+	}
+
+// ----------------------------------------------------------------
+//  Name:           forEachArc
+//  Description:    Calls visit(target, weight) for every arc
+//                  leaving a node.
+// ----------------------------------------------------------------
+	template<class Visitor>
+	void forEachArc(int node, Visitor visit) const {
+		for (int arc = m_offsets[node]; arc < m_offsets[node + 1]; arc++)
+			visit(m_targets[arc], m_weights[arc]);
+	}
+
+// ----------------------------------------------------------------
+//  Name:           forEachReverseArc
+//  Description:    Calls visit(source, weight) for every arc
+//                  entering a node.
+// ----------------------------------------------------------------
+	template<class Visitor>
+	void forEachReverseArc(int node, Visitor visit) const {
+		for (int arc = m_reverseOffsets[node]; arc < m_reverseOffsets[node + 1]; arc++)
+			visit(m_reverseSources[arc], m_reverseWeights[arc]);
+	}
+
+	NodeType heuristic(int node, int dest) const;
+	template<class OpenList>
+	bool aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const;
+	template<class OpenList>
+	SearchResult<NodeType> aStar(int start, int dest, int* path, int capacity, SearchContext<NodeType, OpenList>& context) const;
+	template<class OpenList>
+	SearchResult<NodeType> distance(int start, int dest, SearchContext<NodeType, OpenList>& context) const;
+	int findArc(int from, int to) const;
+	bool applyChanges(const WeightJournal<ArcType>& journal, unsigned int structureVersion);
+};
+
+template<class NodeType, class ArcType>
+GraphCSR<NodeType, ArcType>::GraphCSR() :
+m_offsets(1, 0),
+m_reverseOffsets(1, 0),
+m_version(0),
+m_structureVersion(0) {
+}
+
+// ----------------------------------------------------------------
+//  Name:           GraphCSR
+//  Description:    Constructor, takes ownership of already built
+//                  arrays (the arguments are left empty).
+//  Arguments:      Arc offsets per node (node count + 1 entries),
+//                  arc targets, arc weights, node positions, and the
+//                  weight journal and structure versions they were
+//                  taken at.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+GraphCSR<NodeType, ArcType>::GraphCSR(std::vector<int>& offsets, std::vector<int>& targets,
+	std::vector<ArcType>& weights, std::vector<NodePosition>& positions,
+	unsigned int version, unsigned int structureVersion) :
+m_version(version),
+m_structureVersion(structureVersion) {
+	m_offsets.swap(offsets);
+	m_targets.swap(targets);
+	m_weights.swap(weights);
+	m_positions.swap(positions);
+
+	// count the arcs entering every node, then place each arc
+	int count = nodeCount();
+	m_reverseOffsets.assign(count + 1, 0);
+	for (int arc = 0; arc < arcCount(); arc++)
+		m_reverseOffsets[m_targets[arc] + 1]++;
+	for (int node = 0; node < count; node++)
+		m_reverseOffsets[node + 1] += m_reverseOffsets[node];
+
+	std::vector<int> next(m_reverseOffsets.begin(), m_reverseOffsets.end() - 1);
+	m_reverseSources.resize(arcCount());
+	m_reverseWeights.resize(arcCount());
+	m_reverseArcs.resize(arcCount());
+	for (int node = 0; node < count; node++) {
+		for (int arc = m_offsets[node]; arc < m_offsets[node + 1]; arc++) {
+			int slot = next[m_targets[arc]]++;
+			m_reverseSources[slot] = node;
+			m_reverseWeights[slot] = m_weights[arc];
+			m_reverseArcs[arc] = slot;
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           heuristic
+//  Description:    Straight line estimate between two nodes, the
+//                  same estimate Graph::setHeuristics uses.
+//  Arguments:      The node and the destination node.
+//  Return Value:   The estimated cost.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType GraphCSR<NodeType, ArcType>::heuristic(int node, int dest) const {
+	float dx = m_positions[dest].x - m_positions[node].x;
+	float dy = m_positions[dest].y - m_positions[node].y;
+	return (NodeType)(sqrt((dx * dx) + (dy * dy)));
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search over the flat arrays. The search
+//                  state goes to the context, which is reset first;
+//                  the snapshot itself is never written to.
+//  Arguments:      The start and destination node indices, the
+//                  vector the path (start to dest) is written to and
+//                  the search context.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool GraphCSR<NodeType, ArcType>::aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const {
+	int count = nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+	if (context.size() < count)
+		context.resize(count);
+	context.reset();
+
+	if (aStarSearch(*this, start, dest, context) == false)
+		return false;
+
+	path.clear();
+	for (int node = dest; node != -1; node = context.previous(node))
+		path.push_back(node);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search that writes the path into the caller's
+//                  buffer, so a warmed up context and a reused
+//                  buffer make the query allocation free.
+//  Arguments:      The start and destination node indices, the
+//                  buffer and its capacity in nodes, and the search
+//                  context, which is reset first.
+//  Return Value:   The status and cost; length is the number of
+//                  nodes written, or the capacity needed if the
+//                  buffer was too small (nothing is written then).
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+SearchResult<NodeType> GraphCSR<NodeType, ArcType>::aStar(int start, int dest, int* path, int capacity, SearchContext<NodeType, OpenList>& context) const {
+	typedef SearchResult<NodeType> Result;
+	Result result = distance(start, dest, context);
+	if (result.status != Result::FOUND)
+		return result;
+
+	result.length = writePath(context, dest, path, capacity);
+	if (result.length > capacity)
+		result.status = Result::BUFFER_TOO_SMALL;
+	return result;
+}
+
+// ----------------------------------------------------------------
+//  Name:           distance
+//  Description:    A* search for the cost alone; no path is built.
+//  Arguments:      The start and destination node indices and the
+//                  search context, which is reset first.
+//  Return Value:   The status and cost.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+SearchResult<NodeType> GraphCSR<NodeType, ArcType>::distance(int start, int dest, SearchContext<NodeType, OpenList>& context) const {
+	typedef SearchResult<NodeType> Result;
+	int count = nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return Result(Result::INVALID_NODE, NodeType(-1), 0);
+	if (context.size() < count)
+		context.resize(count);
+	context.reset();
+
+	if (aStarSearch(*this, start, dest, context) == false)
+		return Result(Result::NO_PATH, NodeType(-1), 0);
+	return Result(Result::FOUND, context.gCost(dest), 0);
+}
+
+// ----------------------------------------------------------------
+//  Name:           findArc
+//  Description:    Finds the arc between two nodes.
+//  Arguments:      The source and target node indices.
+//  Return Value:   The arc index, or -1 if there is no such arc.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+int GraphCSR<NodeType, ArcType>::findArc(int from, int to) const {
+	if (from < 0 || from >= nodeCount())
+		return -1;
+	for (int arc = m_offsets[from]; arc < m_offsets[from + 1]; arc++) {
+		if (m_targets[arc] == to)
+			return arc;
+	}
+	return -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           applyChanges
+//  Description:    Brings the weights up to date with a graph's
+//                  weight journal, applying only the changes newer
+//                  than the snapshot's version. The arc layout is
+//                  not touched, so this is far cheaper than freezing
+//                  again. Apply changes between queries, or to a
+//                  copy that is then swapped in, never while another
+//                  thread is searching the snapshot.
+//
+//                  While the layout is unchanged each recorded arc
+//                  index is exactly the arc that changed, so
+//                  parallel arcs between the same nodes are told
+//                  apart by their place in the node's arc list.
+//  Arguments:      The journal of the graph the snapshot came from
+//                  and the graph's current structure version.
+//  Return Value:   false, with no weight changed, if nodes or arcs
+//                  were added or removed since the snapshot was
+//                  frozen, or the journal has discarded changes the
+//                  snapshot has not seen; freeze the graph again
+//                  instead. The version is left as it was then, so
+//                  later calls keep failing until it is.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool GraphCSR<NodeType, ArcType>::applyChanges(const WeightJournal<ArcType>& journal, unsigned int structureVersion) {
+	if (structureVersion != m_structureVersion || m_version < journal.oldestVersion())
+		return false;
+
+	// check every change before writing any, so a failure leaves the
+	// weights as they were
+	bool valid = true;
+	journal.forEachChangeSince(m_version, [&](const WeightChange<ArcType>& change) {
+		int arc = change.arc;
+		if (change.from < 0 || change.from >= nodeCount() || arc < m_offsets[change.from] ||
+			arc >= m_offsets[change.from + 1] || m_targets[arc] != change.to)
+			valid = false;
+	});
+	if (valid == false)
+		return false;
+
+	journal.forEachChangeSince(m_version, [&](const WeightChange<ArcType>& change) {
+		m_weights[change.arc] = change.newWeight;
+		m_reverseWeights[m_reverseArcs[change.arc]] = change.newWeight;
+	});
+	m_version = journal.version();
+	return true;
+}
+
+#endif
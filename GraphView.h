@@ -0,0 +1,238 @@
+#ifndef GRAPHVIEW_H
+#define GRAPHVIEW_H
+
+#include <string>
+#include <vector>
+#include "SFML/Graphics.hpp"
+#include "Graph.h"
+
+// ----------------------------------------------------------------
+//  Name:           GraphView
+//  Description:    Optional SFML view of a Graph. It owns every
+//                  shape and text object used to draw the graph
+//                  and reads the graph and a search context to
+//                  decide how to draw them, so the graph itself
+//                  never depends on SFML.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+class GraphView {
+private:
+
+    // typedef the classes to make our lives easier.
+	typedef Graph<DataType, NodeType, ArcType> GraphType;
+	typedef GraphNode<DataType, NodeType, ArcType> Node;
+	typedef GraphArc<DataType, NodeType, ArcType> Arc;
+
+// ----------------------------------------------------------------
+//  Description:    Everything needed to draw a single node.
+// ----------------------------------------------------------------
+	struct NodeVisual {
+		bool present;
+		bool highlighted;
+		sf::Color highlight;
+		sf::CircleShape shape;
+		sf::Text nameTxt;
+		sf::Text hCostTxt;
+		sf::Text gCostTxt;
+		sf::Text fCostTxt;
+	};
+
+	const GraphType& m_graph;
+	const sf::Font& m_font;
+
+// ----------------------------------------------------------------
+//  Description:    One visual per node slot in the graph.
+// ----------------------------------------------------------------
+	std::vector<NodeVisual> m_nodes;
+
+// ----------------------------------------------------------------
+//  Description:    Two vertices per arc, drawn as sf::Lines.
+// ----------------------------------------------------------------
+	std::vector<sf::Vertex> m_arcLines;
+
+	std::string costString(const std::string& label, NodeType cost, bool known) const;
+
+public:
+	static const int RADIUS = 25;
+
+	GraphView(const GraphType& graph, const sf::Font& font);
+
+	void rebuild();
+	template<class OpenList>
+	void update(const SearchContext<NodeType, OpenList>& context, const std::vector<Node*>& path);
+	void highlight(int index, sf::Color colour);
+	void clearHighlights();
+	int nodeAt(sf::Vector2f point) const;
+	sf::Vector2f position(int index) const;
+	void draw(sf::RenderTarget& target) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           GraphView
+//  Description:    Constructor, builds the shapes for every node
+//                  and arc currently in the graph.
+//  Arguments:      The graph to view and the font for the labels.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+GraphView<DataType, NodeType, ArcType>::GraphView(const GraphType& graph, const sf::Font& font) :
+m_graph(graph),
+m_font(font) {
+	rebuild();
+}
+
+// ----------------------------------------------------------------
+//  Name:           rebuild
+//  Description:    Recreates the node and arc shapes from the
+//                  graph. Call it after nodes or arcs are added
+//                  or removed.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+void GraphView<DataType, NodeType, ArcType>::rebuild() {
+	m_nodes.clear();
+	m_nodes.resize(m_graph.getMaxNodes());
+	m_arcLines.clear();
+
+	for (int i = 0; i < m_graph.getMaxNodes(); i++) {
+		Node* pNode = m_graph.nodeArray()[i];
+		NodeVisual& visual = m_nodes[i];
+		visual.present = (pNode != 0);
+		visual.highlighted = false;
+		if (pNode == 0)
+			continue;
+
+		sf::Vector2f position(pNode->getPosition().x, pNode->getPosition().y);
+		visual.shape = sf::CircleShape(RADIUS);
+		visual.shape.setOrigin(RADIUS, RADIUS);
+		visual.shape.setPosition(position);
+		visual.shape.setFillColor(sf::Color::Blue);
+
+		visual.nameTxt = sf::Text(pNode->data(), m_font, 15);
+		visual.nameTxt.setOrigin(4, 8);
+		visual.nameTxt.setPosition(position.x, position.y + (RADIUS / 2));
+		visual.hCostTxt = sf::Text("H(n)= ?", m_font, 11);
+		visual.hCostTxt.setOrigin(7, 7);
+		visual.hCostTxt.setPosition(position.x - RADIUS, position.y - (RADIUS * 0.75f));
+		visual.gCostTxt = sf::Text("G(n)= ?", m_font, 11);
+		visual.gCostTxt.setOrigin(7, 7);
+		visual.gCostTxt.setPosition(position.x - RADIUS, position.y - (RADIUS * 0.35f));
+		visual.fCostTxt = sf::Text("F(n)= ?", m_font, 11);
+		visual.fCostTxt.setOrigin(7, 7);
+		visual.fCostTxt.setPosition(position.x - RADIUS, position.y);
+
+		for (const Arc& arc : pNode->arcList()) {
+			NodePosition end = arc.node()->getPosition();
+			m_arcLines.push_back(sf::Vertex(position));
+			m_arcLines.push_back(sf::Vertex(sf::Vector2f(end.x, end.y)));
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           update
+//  Description:    Refreshes colours and cost labels from the
+//                  state of a search.
+//  Arguments:      The context the search ran with and the path it
+//                  found (may be empty).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+template<class OpenList>
+void GraphView<DataType, NodeType, ArcType>::update(const SearchContext<NodeType, OpenList>& context, const std::vector<Node*>& path) {
+	for (int i = 0; i < (int)m_nodes.size() && i < context.size(); i++) {
+		NodeVisual& visual = m_nodes[i];
+		if (visual.present == false)
+			continue;
+
+		bool hKnown = context.hCost(i) != -1;
+		bool gKnown = context.gCost(i) != -1;
+		visual.hCostTxt.setString(costString("H(n)= ", context.hCost(i), hKnown));
+		visual.gCostTxt.setString(costString("G(n)= ", context.gCost(i), gKnown));
+		visual.fCostTxt.setString(costString("F(n)= ", context.fCost(i), hKnown && gKnown));
+
+		if (visual.highlighted)
+			visual.shape.setFillColor(visual.highlight);
+		else if (context.marked(i))
+			visual.shape.setFillColor(sf::Color(0, 128, 128, 255));
+		else
+			visual.shape.setFillColor(sf::Color::Blue);
+	}
+
+	for (Node* pNode : path) {
+		NodeVisual& visual = m_nodes[pNode->index()];
+		if (visual.highlighted == false)
+			visual.shape.setFillColor(sf::Color::Magenta);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           highlight
+//  Description:    Gives a node a fixed colour that overrides the
+//                  search colours, e.g. for the origin and goal.
+//  Arguments:      The node index and its colour.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+void GraphView<DataType, NodeType, ArcType>::highlight(int index, sf::Color colour) {
+	m_nodes[index].highlighted = true;
+	m_nodes[index].highlight = colour;
+	m_nodes[index].shape.setFillColor(colour);
+}
+
+template<class DataType, class NodeType, class ArcType>
+void GraphView<DataType, NodeType, ArcType>::clearHighlights() {
+	for (NodeVisual& visual : m_nodes)
+		visual.highlighted = false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           nodeAt
+//  Description:    Finds the node drawn under a point.
+//  Arguments:      The point, in window coordinates.
+//  Return Value:   The node index, or -1 if no node is there.
+// ----------------------------------------------------------------
+template<class DataType, class NodeType, class ArcType>
+int GraphView<DataType, NodeType, ArcType>::nodeAt(sf::Vector2f point) const {
+	for (int i = 0; i < (int)m_nodes.size(); i++) {
+		if (m_nodes[i].present) {
+			sf::Vector2f vectorBetween = m_nodes[i].shape.getPosition() - point;
+			float distanceSquared = (vectorBetween.x * vectorBetween.x) + (vectorBetween.y * vectorBetween.y);
+			if (distanceSquared < (RADIUS * RADIUS))
+				return i;
+		}
+	}
+	return -1;
+}
+
+template<class DataType, class NodeType, class ArcType>
+sf::Vector2f GraphView<DataType, NodeType, ArcType>::position(int index) const {
+	return m_nodes[index].shape.getPosition();
+}
+
+//draw the arcs, then the nodes on top of them
+template<class DataType, class NodeType, class ArcType>
+void GraphView<DataType, NodeType, ArcType>::draw(sf::RenderTarget& target) const {
+	if (m_arcLines.empty() == false)
+		target.draw(&m_arcLines[0], m_arcLines.size(), sf::Lines);
+
+	for (const NodeVisual& visual : m_nodes) {
+		if (visual.present) {
+			target.draw(visual.shape);
+			target.draw(visual.nameTxt);
+			target.draw(visual.hCostTxt);
+			target.draw(visual.gCostTxt);
+			target.draw(visual.fCostTxt);
+		}
+	}
+}
+
+template<class DataType, class NodeType, class ArcType>
+std::string GraphView<DataType, NodeType, ArcType>::costString(const std::string& label, NodeType cost, bool known) const {
+	if (known)
+		return label + std::to_string(cost);
+	return label + "?";
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef GRIDGRAPH_H
+#define GRIDGRAPH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "OccupancyGrid.h"
+#include "SearchContext.h"
+#include "AStarSearch.h"
+
+// ----------------------------------------------------------------
+//  Name:           GridGraph
+//  Description:    A tile map searched as a graph without building
+//                  one. Nodes are cells (index y * width + x) and
+//                  arcs are worked out when a node is expanded, so
+//                  the only storage is the occupancy bits and one
+//                  cost byte per cell.
+//
+//                  Entering a cell costs its cost times the step
+//                  cost from GridMoveCosts. Diagonal steps, when
+//                  enabled, may not cut corners.
+//
+//                  Provides forEachArc and heuristic, so it can be
+//                  searched by aStarSearch like Graph and GraphCSR.
+// ----------------------------------------------------------------
+template<class NodeType>
+class GridGraph {
+private:
+	typedef GridMoveCosts<NodeType> Costs;
+
+	OccupancyGrid m_grid;
+	std::vector<unsigned char> m_costs;
+	bool m_diagonal;
+
+// ----------------------------------------------------------------
+//  Description:    The number of cells at each cost, so the
+//                  cheapest cost on the map is known without a
+//                  scan when cells are raised. That cost scales the
+//                  heuristic so it never overestimates.
+// ----------------------------------------------------------------
+	std::vector<int> m_costCounts;
+	unsigned char m_minCost;
+
+public:
+	GridGraph(int width, int height, bool diagonal = true) :
+	m_grid(width, height),
+	m_costs((size_t)width * height, 1),
+	m_diagonal(diagonal),
+	m_costCounts(256, 0),
+	m_minCost(1) {
+		m_costCounts[1] = (int)m_costs.size();
+	}
+
+    // Accessors
+	const OccupancyGrid& grid() const {
+		return m_grid;
+	}
+
+	int nodeCount() const {
+		return m_grid.cellCount();
+	}
+
+	int index(int x, int y) const {
+		return m_grid.index(x, y);
+	}
+
+	unsigned char cost(int x, int y) const {
+		return m_costs[m_grid.index(x, y)];
+	}
+
+	void setBlocked(int x, int y, bool blocked) {
+		m_grid.setBlocked(x, y, blocked);
+	}
+
+	bool setCost(int x, int y, unsigned char cost);
+
+// ----------------------------------------------------------------
+//  Name:           forEachArc
+//  Description:    Calls visit(target, weight) for every free cell
+//                  next to a cell.
+// ----------------------------------------------------------------
+	template<class Visitor>
+	void forEachArc(int node, Visitor visit) const {
+		int width = m_grid.width();
+		int x = node % width;
+		int y = node / width;
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				if (dx == 0 && dy == 0)
+					continue;
+				bool diagonal = dx != 0 && dy != 0;
+				if (diagonal && (m_diagonal == false || m_grid.passable(x + dx, y) == false || m_grid.passable(x, y + dy) == false))
+					continue;
+				if (m_grid.passable(x + dx, y + dy) == false)
+					continue;
+				int target = node + (dy * width) + dx;
+				visit(target, (NodeType)((diagonal ? Costs::diagonal() : Costs::straight()) * m_costs[target]));
+			}
+		}
+	}
+
+	NodeType heuristic(int node, int dest) const;
+
+	template<class OpenList>
+	bool aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           setCost
+//  Description:    Sets the cost of entering a cell.
+//  Arguments:      The cell and its cost, which must be at least 1.
+//  Return Value:   false if the cost is 0.
+// ----------------------------------------------------------------
+template<class NodeType>
+bool GridGraph<NodeType>::setCost(int x, int y, unsigned char cost) {
+	if (cost == 0)
+		return false;
+	unsigned char& cell = m_costs[m_grid.index(x, y)];
+	m_costCounts[cell]--;
+	m_costCounts[cost]++;
+	cell = cost;
+	if (cost < m_minCost)
+		m_minCost = cost;
+	// the last cell at the cheapest cost was raised
+	while (m_costCounts[m_minCost] == 0 && m_minCost < 255)
+		m_minCost++;
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           heuristic
+//  Description:    Octile distance (Manhattan without diagonals)
+//                  at the cheapest cell cost.
+//  Arguments:      The node and destination cell indices.
+//  Return Value:   The estimated cost.
+// ----------------------------------------------------------------
+template<class NodeType>
+NodeType GridGraph<NodeType>::heuristic(int node, int dest) const {
+	int width = m_grid.width();
+	int dx = std::abs((node % width) - (dest % width));
+	int dy = std::abs((node / width) - (dest / width));
+	if (m_diagonal == false)
+		return (NodeType)(Costs::straight() * (dx + dy) * m_minCost);
+	int diagonal = std::min(dx, dy);
+	return (NodeType)((Costs::diagonal() * diagonal + Costs::straight() * (std::max(dx, dy) - diagonal)) * m_minCost);
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search between two cells. Same inputs and
+//                  output as GraphCSR::aStar.
+//  Arguments:      The start and destination cell indices, the
+//                  vector the path is written to and the search
+//                  context, which is reset first.
+//  Return Value:   true if a path was found; false if either cell
+//                  is blocked.
+// ----------------------------------------------------------------
+template<class NodeType>
+template<class OpenList>
+bool GridGraph<NodeType>::aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const {
+	int count = nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+	int width = m_grid.width();
+	if (m_grid.passable(start % width, start / width) == false || m_grid.passable(dest % width, dest / width) == false)
+		return false;
+	if (context.size() < count)
+		context.resize(count);
+	context.reset();
+
+	if (aStarSearch(*this, start, dest, context) == false)
+		return false;
+
+	path.clear();
+	for (int node = dest; node != -1; node = context.previous(node))
+		path.push_back(node);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+#endif
@@ -0,0 +1,556 @@
+#ifndef HIERARCHICALASTAR_H
+#define HIERARCHICALASTAR_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+#include "AStarSearch.h"
+
+// ----------------------------------------------------------------
+//  Name:           HierarchicalContext
+//  Description:    Search state for a hierarchical search: one
+//                  context for searches inside a cluster and one
+//                  for the search over the abstract graph.
+// ----------------------------------------------------------------
+template<class NodeType, class OpenList = typename DefaultOpenList<NodeType>::type>
+struct HierarchicalContext {
+	SearchContext<NodeType, OpenList> local;
+	SearchContext<NodeType, OpenList> abstract;
+};
+
+// ----------------------------------------------------------------
+//  Name:           HierarchicalAStar
+//  Description:    HPA* (hierarchical path-finding A*). Nodes are
+//                  split into square clusters by position. Nodes
+//                  with an arc to or from another cluster are
+//                  entrances, and they form a small abstract graph:
+//                  the arcs between clusters, plus for each pair of
+//                  entrances in a cluster the cost of the shortest
+//                  path between them inside the cluster.
+//
+//                  A query links the start and destination to the
+//                  entrances of their clusters, searches the
+//                  abstract graph, then refines each step of the
+//                  abstract path with a search confined to one
+//                  cluster. Every boundary node is an entrance, so
+//                  the paths found are still shortest paths.
+//
+//                  The snapshot is held by reference. After editing
+//                  the graph, freeze it into the same snapshot
+//                  object and call updateCluster() for the clusters
+//                  whose arcs changed.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class HierarchicalAStar {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    An abstract arc. target is an abstract node.
+// ----------------------------------------------------------------
+	struct AbstractArc {
+		int target;
+		NodeType cost;
+
+		AbstractArc(int t, NodeType c) : target(t), cost(c) {}
+	};
+
+// ----------------------------------------------------------------
+//  Description:    The snapshot seen through one cluster: only arcs
+//                  between nodes of the cluster, optionally
+//                  reversed. With no destination (-1) the heuristic
+//                  is 0, which makes aStarSearch a Dijkstra search
+//                  over the whole cluster.
+// ----------------------------------------------------------------
+	struct ClusterView {
+		const HierarchicalAStar& owner;
+		int cluster;
+		bool reverse;
+
+		template<class Visitor>
+		void forEachArc(int node, Visitor visit) const {
+			auto inside = [&](int other, ArcType weight) {
+				if (owner.m_clusters[other] == cluster)
+					visit(other, weight);
+			};
+			if (reverse)
+				owner.m_graph.forEachReverseArc(node, inside);
+			else
+				owner.m_graph.forEachArc(node, inside);
+		}
+
+		NodeType heuristic(int node, int dest) const {
+			if (dest == -1)
+				return NodeType();
+			return owner.m_graph.heuristic(node, dest);
+		}
+	};
+
+// ----------------------------------------------------------------
+//  Description:    The abstract graph with the query's start and
+//                  destination added as the two nodes after the
+//                  entrances.
+// ----------------------------------------------------------------
+	struct QueryView {
+		const HierarchicalAStar& owner;
+		const std::vector<AbstractArc>& startArcs;
+		const std::vector<NodeType>& toDest;
+		int start;
+		int dest;
+
+		template<class Visitor>
+		void forEachArc(int node, Visitor visit) const {
+			int entrances = (int)owner.m_entrances.size();
+			if (node == entrances) {
+				for (const AbstractArc& arc : startArcs)
+					visit(arc.target, arc.cost);
+			}
+			else if (node < entrances) {
+				for (const AbstractArc& arc : owner.m_arcs[node])
+					visit(arc.target, arc.cost);
+				if (toDest[node] != -1)
+					visit(entrances + 1, toDest[node]);
+			}
+		}
+
+		NodeType heuristic(int node, int) const {
+			return owner.m_graph.heuristic(owner.realNode(node, start, dest), dest);
+		}
+	};
+
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+	float m_clusterSize;
+	float m_originX;
+	float m_originY;
+	int m_columns;
+
+// ----------------------------------------------------------------
+//  Description:    Cluster of every node, and the nodes of every
+//                  cluster (cluster c is m_clusterNodes from
+//                  m_clusterOffsets[c] to m_clusterOffsets[c + 1]).
+// ----------------------------------------------------------------
+	std::vector<int> m_clusters;
+	std::vector<int> m_clusterOffsets;
+	std::vector<int> m_clusterNodes;
+
+// ----------------------------------------------------------------
+//  Description:    Abstract node of every graph node (-1 if it is
+//                  not an entrance), the graph node of every
+//                  abstract node and the arcs leaving each one.
+// ----------------------------------------------------------------
+	std::vector<int> m_abstractIndex;
+	std::vector<int> m_entrances;
+	std::vector<std::vector<AbstractArc> > m_arcs;
+
+// ----------------------------------------------------------------
+//  Description:    The arcs (from, to) crossing each cluster's
+//                  boundary, in or out, as they were at build().
+//                  The entrances were chosen from these, so while
+//                  they stay the same the entrances still fit.
+// ----------------------------------------------------------------
+	std::vector<std::vector<std::pair<int, int> > > m_crossings;
+
+	bool hasArcs(int node) const;
+	bool isEntrance(int node) const;
+	void findCrossings(int cluster, std::vector<std::pair<int, int> >& crossings) const;
+	void selectEntrances(int entrancesPerSide);
+	void linkEntrance(int entrance, SearchContext<NodeType>& context);
+
+	int realNode(int node, int start, int dest) const {
+		int entrances = (int)m_entrances.size();
+		if (node < entrances)
+			return m_entrances[node];
+		return node == entrances ? start : dest;
+	}
+
+	template<class OpenList>
+	bool refine(int from, int to, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const;
+
+public:
+	HierarchicalAStar(const GraphCSR<NodeType, ArcType>& graph) :
+	m_graph(graph),
+	m_clusterSize(0),
+	m_originX(0),
+	m_originY(0),
+	m_columns(0) {
+	}
+
+	bool build(float clusterSize, int entrancesPerSide = 0);
+	bool updateCluster(int cluster);
+
+	template<class OpenList>
+	bool aStar(int start, int dest, std::vector<int>& path, HierarchicalContext<NodeType, OpenList>& context) const;
+
+    // Accessors
+	int clusterOf(int node) const {
+		return m_clusters[node];
+	}
+
+	int clusterCount() const {
+		return (int)m_clusterOffsets.size() - 1;
+	}
+
+	int entranceCount() const {
+		return (int)m_entrances.size();
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Splits the nodes into clusters and builds the
+//                  abstract graph from scratch.
+//  Arguments:      The width and height of a cluster, in the same
+//                  units as the node positions, and the most arcs
+//                  kept between two neighbouring clusters in each
+//                  direction. 0 keeps every node on a boundary as
+//                  an entrance, so paths are shortest paths. A
+//                  small limit makes the abstract graph far smaller
+//                  and paths slightly longer, as in the original
+//                  HPA*, and a cluster whose inside is not
+//                  connected may then lose a way through it.
+//  Return Value:   false if the size is not positive.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool HierarchicalAStar<NodeType, ArcType>::build(float clusterSize, int entrancesPerSide) {
+	if (clusterSize <= 0)
+		return false;
+
+	int count = m_graph.nodeCount();
+	m_clusterSize = clusterSize;
+	m_originX = 0;
+	m_originY = 0;
+	float maxX = 0;
+	float maxY = 0;
+	bool first = true;
+	for (int node = 0; node < count; node++) {
+		// empty slots come out of freeze() at (0, 0) with no arcs, and
+		// would stretch the grid; they cannot be on a path anyway
+		if (hasArcs(node) == false)
+			continue;
+		const NodePosition& position = m_graph.position(node);
+		if (first || position.x < m_originX)
+			m_originX = position.x;
+		if (first || position.y < m_originY)
+			m_originY = position.y;
+		if (first || position.x > maxX)
+			maxX = position.x;
+		if (first || position.y > maxY)
+			maxY = position.y;
+		first = false;
+	}
+	m_columns = (int)((maxX - m_originX) / clusterSize) + 1;
+	int rows = (int)((maxY - m_originY) / clusterSize) + 1;
+
+	// bucket the nodes by cluster; nodes without arcs may lie outside
+	// the grid and go to the nearest cluster
+	m_clusters.resize(count);
+	m_clusterOffsets.assign((m_columns * rows) + 1, 0);
+	for (int node = 0; node < count; node++) {
+		const NodePosition& position = m_graph.position(node);
+		int column = (int)((position.x - m_originX) / clusterSize);
+		int row = (int)((position.y - m_originY) / clusterSize);
+		column = std::max(0, std::min(column, m_columns - 1));
+		row = std::max(0, std::min(row, rows - 1));
+		m_clusters[node] = (row * m_columns) + column;
+		m_clusterOffsets[m_clusters[node] + 1]++;
+	}
+	for (int cluster = 0; cluster < m_columns * rows; cluster++)
+		m_clusterOffsets[cluster + 1] += m_clusterOffsets[cluster];
+	std::vector<int> next(m_clusterOffsets.begin(), m_clusterOffsets.end() - 1);
+	m_clusterNodes.resize(count);
+	for (int node = 0; node < count; node++)
+		m_clusterNodes[next[m_clusters[node]]++] = node;
+	m_crossings.resize(m_columns * rows);
+	for (int cluster = 0; cluster < m_columns * rows; cluster++)
+		findCrossings(cluster, m_crossings[cluster]);
+
+	m_abstractIndex.assign(count, -1);
+	m_entrances.clear();
+	if (entrancesPerSide <= 0) {
+		for (int node = 0; node < count; node++) {
+			if (isEntrance(node))
+				m_abstractIndex[node] = 0;
+		}
+	}
+	else {
+		selectEntrances(entrancesPerSide);
+	}
+	for (int node = 0; node < count; node++) {
+		if (m_abstractIndex[node] != -1) {
+			m_abstractIndex[node] = (int)m_entrances.size();
+			m_entrances.push_back(node);
+		}
+	}
+
+	m_arcs.assign(m_entrances.size(), std::vector<AbstractArc>());
+	SearchContext<NodeType> context(count);
+	for (int entrance = 0; entrance < (int)m_entrances.size(); entrance++)
+		linkEntrance(entrance, context);
+	return true;
+}
+
+// true if any arc enters or leaves the node
+template<class NodeType, class ArcType>
+bool HierarchicalAStar<NodeType, ArcType>::hasArcs(int node) const {
+	if (m_graph.arcBegin(node) != m_graph.arcEnd(node))
+		return true;
+	bool entered = false;
+	m_graph.forEachReverseArc(node, [&](int, ArcType) {
+		entered = true;
+	});
+	return entered;
+}
+
+// true if the node has an arc to or from another cluster
+template<class NodeType, class ArcType>
+bool HierarchicalAStar<NodeType, ArcType>::isEntrance(int node) const {
+	bool crosses = false;
+	auto check = [&](int other, ArcType) {
+		if (m_clusters[other] != m_clusters[node])
+			crosses = true;
+	};
+	m_graph.forEachArc(node, check);
+	m_graph.forEachReverseArc(node, check);
+	return crosses;
+}
+
+// ----------------------------------------------------------------
+//  Name:           findCrossings
+//  Description:    Lists the arcs into and out of a cluster, as
+//                  sorted (from, to) pairs.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void HierarchicalAStar<NodeType, ArcType>::findCrossings(int cluster, std::vector<std::pair<int, int> >& crossings) const {
+	crossings.clear();
+	for (int i = m_clusterOffsets[cluster]; i < m_clusterOffsets[cluster + 1]; i++) {
+		int node = m_clusterNodes[i];
+		m_graph.forEachArc(node, [&](int target, ArcType) {
+			if (m_clusters[target] != cluster)
+				crossings.push_back(std::make_pair(node, target));
+		});
+		m_graph.forEachReverseArc(node, [&](int source, ArcType) {
+			if (m_clusters[source] != cluster)
+				crossings.push_back(std::make_pair(source, node));
+		});
+	}
+	std::sort(crossings.begin(), crossings.end());
+}
+
+// ----------------------------------------------------------------
+//  Name:           selectEntrances
+//  Description:    Marks (with 0 in m_abstractIndex) the ends of at
+//                  most entrancesPerSide arcs from each cluster to
+//                  each neighbour, spread evenly along the boundary.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void HierarchicalAStar<NodeType, ArcType>::selectEntrances(int entrancesPerSide) {
+	struct Crossing {
+		int from;
+		int to;
+		float along;
+
+		bool operator<(const Crossing& other) const {
+			return along < other.along;
+		}
+	};
+
+	// crossing arcs grouped by the pair of clusters they join
+	std::vector<std::pair<std::pair<int, int>, Crossing> > crossings;
+	for (int node = 0; node < m_graph.nodeCount(); node++) {
+		m_graph.forEachArc(node, [&](int target, ArcType) {
+			int from = m_clusters[node];
+			int to = m_clusters[target];
+			if (from == to)
+				return;
+			const NodePosition& a = m_graph.position(node);
+			const NodePosition& b = m_graph.position(target);
+			// neighbours side by side share an upright boundary
+			bool sameRow = from / m_columns == to / m_columns;
+			Crossing crossing = { node, target, sameRow ? (a.y + b.y) / 2 : (a.x + b.x) / 2 };
+			crossings.push_back(std::make_pair(std::make_pair(from, to), crossing));
+		});
+	}
+	std::sort(crossings.begin(), crossings.end());
+
+	size_t first = 0;
+	while (first < crossings.size()) {
+		size_t last = first;
+		while (last < crossings.size() && crossings[last].first == crossings[first].first)
+			last++;
+		size_t size = last - first;
+		size_t keep = std::min(size, (size_t)entrancesPerSide);
+		for (size_t i = 0; i < keep; i++) {
+			const Crossing& crossing = crossings[first + ((i * 2 + 1) * size) / (keep * 2)].second;
+			m_abstractIndex[crossing.from] = 0;
+			m_abstractIndex[crossing.to] = 0;
+		}
+		first = last;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           linkEntrance
+//  Description:    Rebuilds the arcs leaving one entrance: its arcs
+//                  into other clusters, and the cheapest path to
+//                  every other entrance of its cluster found by a
+//                  Dijkstra search that stays in the cluster.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void HierarchicalAStar<NodeType, ArcType>::linkEntrance(int entrance, SearchContext<NodeType>& context) {
+	typedef SearchContext<NodeType> Context;
+
+	int node = m_entrances[entrance];
+	int cluster = m_clusters[node];
+	std::vector<AbstractArc>& arcs = m_arcs[entrance];
+	arcs.clear();
+
+	m_graph.forEachArc(node, [&](int target, ArcType weight) {
+		if (m_clusters[target] != cluster && m_abstractIndex[target] != -1)
+			arcs.push_back(AbstractArc(m_abstractIndex[target], (NodeType)weight));
+	});
+
+	ClusterView view = { *this, cluster, false };
+	context.reset();
+	aStarSearch(view, node, -1, context);
+	for (int i = m_clusterOffsets[cluster]; i < m_clusterOffsets[cluster + 1]; i++) {
+		int other = m_clusterNodes[i];
+		if (other != node && m_abstractIndex[other] != -1 && context.state(other) == Context::CLOSED)
+			arcs.push_back(AbstractArc(m_abstractIndex[other], context.gCost(other)));
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           updateCluster
+//  Description:    Recomputes the abstract arcs leaving the
+//                  entrances of one cluster, after arcs leaving its
+//                  nodes have been added, removed or reweighted.
+//                  Much cheaper than build(), but it cannot add or
+//                  remove entrances.
+//  Arguments:      The cluster.
+//  Return Value:   false if an arc now crosses, or no longer
+//                  crosses, the cluster's boundary, with either
+//                  entrance choice: the entrances may no longer
+//                  fit, so call build() instead.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool HierarchicalAStar<NodeType, ArcType>::updateCluster(int cluster) {
+	if (cluster < 0 || cluster >= clusterCount() || m_graph.nodeCount() != (int)m_clusters.size())
+		return false;
+
+	std::vector<std::pair<int, int> > crossings;
+	findCrossings(cluster, crossings);
+	if (crossings != m_crossings[cluster])
+		return false;
+
+	SearchContext<NodeType> context(m_graph.nodeCount());
+	for (int i = m_clusterOffsets[cluster]; i < m_clusterOffsets[cluster + 1]; i++) {
+		int node = m_clusterNodes[i];
+		if (m_abstractIndex[node] != -1)
+			linkEntrance(m_abstractIndex[node], context);
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    Hierarchical search. Same inputs and output as
+//                  GraphCSR::aStar.
+//  Arguments:      The start and destination node indices, the
+//                  vector the path (start to dest) is written to and
+//                  the search context.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool HierarchicalAStar<NodeType, ArcType>::aStar(int start, int dest, std::vector<int>& path, HierarchicalContext<NodeType, OpenList>& context) const {
+	typedef SearchContext<NodeType, OpenList> Context;
+
+	int count = m_graph.nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count || count != (int)m_clusters.size())
+		return false;
+	if (context.local.size() < count)
+		context.local.resize(count);
+
+	int entrances = (int)m_entrances.size();
+	int startCluster = m_clusters[start];
+	int destCluster = m_clusters[dest];
+	std::vector<AbstractArc> startArcs;
+	std::vector<NodeType> toDest(entrances, -1);
+
+	// link the start to the entrances of its cluster, and to dest if
+	// dest is in the same cluster
+	ClusterView startView = { *this, startCluster, false };
+	context.local.reset();
+	aStarSearch(startView, start, -1, context.local);
+	for (int i = m_clusterOffsets[startCluster]; i < m_clusterOffsets[startCluster + 1]; i++) {
+		int node = m_clusterNodes[i];
+		if (context.local.state(node) != Context::CLOSED)
+			continue;
+		if (m_abstractIndex[node] != -1)
+			startArcs.push_back(AbstractArc(m_abstractIndex[node], context.local.gCost(node)));
+		if (node == dest)
+			startArcs.push_back(AbstractArc(entrances + 1, context.local.gCost(node)));
+	}
+
+	// and the entrances of dest's cluster to dest, searching backwards
+	ClusterView destView = { *this, destCluster, true };
+	context.local.reset();
+	aStarSearch(destView, dest, -1, context.local);
+	for (int i = m_clusterOffsets[destCluster]; i < m_clusterOffsets[destCluster + 1]; i++) {
+		int node = m_clusterNodes[i];
+		if (m_abstractIndex[node] != -1 && context.local.state(node) == Context::CLOSED)
+			toDest[m_abstractIndex[node]] = context.local.gCost(node);
+	}
+
+	if (context.abstract.size() < entrances + 2)
+		context.abstract.resize(entrances + 2);
+	context.abstract.reset();
+	QueryView view = { *this, startArcs, toDest, start, dest };
+	if (aStarSearch(view, entrances, entrances + 1, context.abstract) == false)
+		return false;
+
+	std::vector<int> abstractPath;
+	for (int node = entrances + 1; node != -1; node = context.abstract.previous(node))
+		abstractPath.push_back(realNode(node, start, dest));
+	std::reverse(abstractPath.begin(), abstractPath.end());
+
+	path.assign(1, start);
+	for (size_t i = 1; i < abstractPath.size(); i++) {
+		if (refine(abstractPath[i - 1], abstractPath[i], path, context.local) == false)
+			return false;
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           refine
+//  Description:    Appends the nodes after from on one step of the
+//                  abstract path: the arc itself between clusters,
+//                  or an A* search kept inside the cluster.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool HierarchicalAStar<NodeType, ArcType>::refine(int from, int to, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const {
+	if (from == to)
+		return true;
+	if (m_clusters[from] != m_clusters[to]) {
+		path.push_back(to);
+		return true;
+	}
+
+	ClusterView view = { *this, m_clusters[from], false };
+	context.reset();
+	if (aStarSearch(view, from, to, context) == false)
+		return false;
+
+	size_t end = path.size();
+	for (int node = to; node != from; node = context.previous(node))
+		path.push_back(node);
+	std::reverse(path.begin() + end, path.end());
+	return true;
+}
+
+#endif
@@ -0,0 +1,322 @@
+#ifndef HUBLABELS_H
+#define HUBLABELS_H
+
+#include <vector>
+#include <algorithm>
+#include "ContractionHierarchy.h"
+
+// ----------------------------------------------------------------
+//  Name:           HubLabels
+//  Description:    A distance oracle built from a contraction
+//                  hierarchy. Every node v has a forward label, a
+//                  list of (hub, d(v, hub)), and a backward label,
+//                  a list of (hub, d(hub, v)). The labels are
+//                  chosen so that for any pair s, t some hub on a
+//                  shortest s-t path is in both the forward label
+//                  of s and the backward label of t, so
+//                      d(s, t) = min over shared hubs of
+//                                d(s, hub) + d(hub, t)
+//                  Labels are sorted by hub, so a query is one
+//                  merge of two short arrays and visits no graph
+//                  nodes at all.
+//
+//                  The labels are the CH search spaces of each node,
+//                  built from the highest rank down, with entries
+//                  removed when they are not a shortest distance.
+//                  The hierarchy must outlive the labels when paths
+//                  are wanted; distances do not use it.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class HubLabels {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    One direction's labels, flattened. The label of
+//                  node v is entries offsets[v] to offsets[v + 1].
+//                  parents[] is the next node towards the hub (the
+//                  node before it for backward labels), -1 when the
+//                  hub is the node itself; only used for paths.
+// ----------------------------------------------------------------
+	struct Labels {
+		std::vector<int> offsets;
+		std::vector<int> hubs;
+		std::vector<NodeType> distances;
+		std::vector<int> parents;
+	};
+
+	struct Entry {
+		int hub;
+		NodeType distance;
+		int parent;
+
+		Entry(int h, NodeType d, int p) : hub(h), distance(d), parent(p) {}
+
+		bool operator<(const Entry& other) const {
+			return hub < other.hub || (hub == other.hub && distance < other.distance);
+		}
+	};
+
+	typedef std::vector<std::vector<Entry> > WorkLabels;
+
+	const ContractionHierarchy<NodeType, ArcType>& m_hierarchy;
+
+	Labels m_forward;
+	Labels m_backward;
+
+	static bool merge(const std::vector<Entry>& first, const std::vector<Entry>& second, NodeType& cost);
+	static void flatten(const WorkLabels& work, Labels& labels);
+	int find(const Labels& labels, int node, int hub) const;
+	bool meet(int start, int dest, int& forwardEntry, int& backwardEntry) const;
+
+public:
+	HubLabels(const ContractionHierarchy<NodeType, ArcType>& hierarchy) : m_hierarchy(hierarchy) {}
+
+	void build();
+	bool distance(int start, int dest, NodeType& cost) const;
+	bool path(int start, int dest, std::vector<int>& path) const;
+
+// ----------------------------------------------------------------
+//  Name:           averageLabelSize
+//  Description:    Mean number of entries per label, forward and
+//                  backward together.
+// ----------------------------------------------------------------
+	double averageLabelSize() const {
+		int count = (int)m_forward.offsets.size() - 1;
+		if (count <= 0)
+			return 0.0;
+		return (double)(m_forward.hubs.size() + m_backward.hubs.size()) / (2.0 * count);
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Builds both labels of every node, highest rank
+//                  first. A node's forward label is itself plus
+//                  the forward labels of its upward neighbours,
+//                  extended by the arc to them; an entry is then
+//                  dropped if the finished labels of its hub give a
+//                  shorter distance. Backward labels are the same
+//                  over the downward arcs.
+//  Arguments:      None. The hierarchy must already be built.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void HubLabels<NodeType, ArcType>::build() {
+	int count = m_hierarchy.nodeCount();
+	std::vector<int> order(count);
+	for (int node = 0; node < count; node++)
+		order[m_hierarchy.rank(node)] = node;
+
+	WorkLabels forward(count);
+	WorkLabels backward(count);
+	std::vector<Entry> candidates;
+	std::vector<bool> pruned;
+
+	for (int i = count - 1; i >= 0; i--) {
+		int node = order[i];
+
+		for (int side = 0; side < 2; side++) {
+			WorkLabels& labels = side == 0 ? forward : backward;
+			WorkLabels& opposite = side == 0 ? backward : forward;
+
+			candidates.clear();
+			candidates.push_back(Entry(node, NodeType(), -1));
+			auto extend = [&](int neighbour, NodeType weight) {
+				for (const Entry& entry : labels[neighbour])
+					candidates.push_back(Entry(entry.hub, entry.distance + weight, neighbour));
+			};
+			if (side == 0)
+				m_hierarchy.forEachUpArc(node, extend);
+			else
+				m_hierarchy.forEachDownArc(node, extend);
+
+			// keep the shortest entry per hub
+			std::sort(candidates.begin(), candidates.end());
+			std::vector<Entry>& label = labels[node];
+			for (const Entry& entry : candidates) {
+				if (label.empty() || label.back().hub != entry.hub)
+					label.push_back(entry);
+			}
+
+			// drop entries that are not a shortest distance; the hub has a
+			// higher rank, so its labels are already finished
+			pruned.assign(label.size(), false);
+			for (size_t e = 0; e < label.size(); e++) {
+				NodeType shortest;
+				if (label[e].hub == node)
+					continue;
+				const std::vector<Entry>& hubLabel = opposite[label[e].hub];
+				bool found = side == 0 ? merge(label, hubLabel, shortest) : merge(hubLabel, label, shortest);
+				pruned[e] = found && shortest < label[e].distance;
+			}
+			size_t kept = 0;
+			for (size_t e = 0; e < label.size(); e++) {
+				if (pruned[e] == false)
+					label[kept++] = label[e];
+			}
+			label.erase(label.begin() + kept, label.end());
+		}
+	}
+
+	flatten(forward, m_forward);
+	flatten(backward, m_backward);
+}
+
+// ----------------------------------------------------------------
+//  Name:           merge
+//  Description:    Shortest distance through a hub shared by a
+//                  forward and a backward label.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool HubLabels<NodeType, ArcType>::merge(const std::vector<Entry>& first, const std::vector<Entry>& second, NodeType& cost) {
+	bool found = false;
+	size_t i = 0;
+	size_t j = 0;
+	while (i < first.size() && j < second.size()) {
+		if (first[i].hub < second[j].hub) {
+			i++;
+		}
+		else if (second[j].hub < first[i].hub) {
+			j++;
+		}
+		else {
+			NodeType length = first[i].distance + second[j].distance;
+			if (found == false || length < cost) {
+				cost = length;
+				found = true;
+			}
+			i++;
+			j++;
+		}
+	}
+	return found;
+}
+
+template<class NodeType, class ArcType>
+void HubLabels<NodeType, ArcType>::flatten(const WorkLabels& work, Labels& labels) {
+	labels.offsets.assign(work.size() + 1, 0);
+	labels.hubs.clear();
+	labels.distances.clear();
+	labels.parents.clear();
+	for (size_t node = 0; node < work.size(); node++) {
+		for (const Entry& entry : work[node]) {
+			labels.hubs.push_back(entry.hub);
+			labels.distances.push_back(entry.distance);
+			labels.parents.push_back(entry.parent);
+		}
+		labels.offsets[node + 1] = (int)labels.hubs.size();
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           meet
+//  Description:    Finds the best shared hub of two nodes.
+//  Arguments:      The start and destination nodes and the indices
+//                  of the hub's entry in each label, set on return.
+//  Return Value:   true if the labels share a hub.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool HubLabels<NodeType, ArcType>::meet(int start, int dest, int& forwardEntry, int& backwardEntry) const {
+	int i = m_forward.offsets[start];
+	int iEnd = m_forward.offsets[start + 1];
+	int j = m_backward.offsets[dest];
+	int jEnd = m_backward.offsets[dest + 1];
+	const int* forwardHubs = m_forward.hubs.data();
+	const int* backwardHubs = m_backward.hubs.data();
+
+	NodeType best = NodeType();
+	forwardEntry = -1;
+	while (i < iEnd && j < jEnd) {
+		if (forwardHubs[i] < backwardHubs[j]) {
+			i++;
+		}
+		else if (backwardHubs[j] < forwardHubs[i]) {
+			j++;
+		}
+		else {
+			NodeType length = m_forward.distances[i] + m_backward.distances[j];
+			if (forwardEntry == -1 || length < best) {
+				best = length;
+				forwardEntry = i;
+				backwardEntry = j;
+			}
+			i++;
+			j++;
+		}
+	}
+	return forwardEntry != -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           distance
+//  Description:    The cost of the shortest path between two nodes.
+//  Arguments:      The start and destination node indices and the
+//                  variable the cost is written to.
+//  Return Value:   true if dest can be reached.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool HubLabels<NodeType, ArcType>::distance(int start, int dest, NodeType& cost) const {
+	int count = (int)m_forward.offsets.size() - 1;
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+
+	int forwardEntry;
+	int backwardEntry;
+	if (meet(start, dest, forwardEntry, backwardEntry) == false)
+		return false;
+	cost = m_forward.distances[forwardEntry] + m_backward.distances[backwardEntry];
+	return true;
+}
+
+// finds a hub in a node's label, -1 if it is not there
+template<class NodeType, class ArcType>
+int HubLabels<NodeType, ArcType>::find(const Labels& labels, int node, int hub) const {
+	const int* begin = labels.hubs.data() + labels.offsets[node];
+	const int* end = labels.hubs.data() + labels.offsets[node + 1];
+	const int* entry = std::lower_bound(begin, end, hub);
+	if (entry == end || *entry != hub)
+		return -1;
+	return (int)(entry - labels.hubs.data());
+}
+
+// ----------------------------------------------------------------
+//  Name:           path
+//  Description:    The shortest path between two nodes. Follows the
+//                  label parents from both ends to the shared hub,
+//                  then unpacks the hierarchy's shortcuts, so this
+//                  is much slower than distance().
+//  Arguments:      The start and destination node indices and the
+//                  vector the path (start to dest) is written to.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool HubLabels<NodeType, ArcType>::path(int start, int dest, std::vector<int>& path) const {
+	int count = (int)m_forward.offsets.size() - 1;
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+
+	int forwardEntry;
+	int backwardEntry;
+	if (meet(start, dest, forwardEntry, backwardEntry) == false)
+		return false;
+	int hub = m_forward.hubs[forwardEntry];
+
+	// start up to the hub, then the hub down to dest, in hierarchy arcs
+	std::vector<int> hierarchyPath;
+	hierarchyPath.push_back(start);
+	for (int node = start; node != hub; ) {
+		node = m_forward.parents[find(m_forward, node, hub)];
+		hierarchyPath.push_back(node);
+	}
+	std::vector<int> down;
+	for (int node = dest; node != hub; ) {
+		down.push_back(node);
+		node = m_backward.parents[find(m_backward, node, hub)];
+	}
+	hierarchyPath.insert(hierarchyPath.end(), down.rbegin(), down.rend());
+
+	m_hierarchy.unpackPath(hierarchyPath, path);
+	return true;
+}
+
+#endif
@@ -0,0 +1,470 @@
+#ifndef INCREMENTALPLANNER_H
+#define INCREMENTALPLANNER_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "GraphCSR.h"
+
+// ----------------------------------------------------------------
+//  Name:           IncrementalKey
+//  Description:    The two part priority of LPA* and D* Lite,
+//                  compared first on k1 then on k2.
+// ----------------------------------------------------------------
+template<class NodeType>
+struct IncrementalKey {
+	NodeType k1;
+	NodeType k2;
+
+	IncrementalKey() {}
+	IncrementalKey(NodeType first, NodeType second) : k1(first), k2(second) {}
+
+	bool operator<(const IncrementalKey& other) const {
+		return k1 < other.k1 || (k1 == other.k1 && k2 < other.k2);
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           IncrementalQueue
+//  Description:    Indexed binary heap over two part keys. Unlike
+//                  the open lists in OpenList.h a queued node can
+//                  be moved either way or taken out again, which
+//                  the incremental planners need when a change
+//                  makes a node consistent.
+// ----------------------------------------------------------------
+template<class NodeType>
+class IncrementalQueue {
+private:
+	typedef IncrementalKey<NodeType> Key;
+
+	struct Entry {
+		Key key;
+		int node;
+	};
+
+	std::vector<Entry> m_heap;
+	std::vector<int> m_position;
+
+	void place(int index, const Entry& entry) {
+		m_heap[index] = entry;
+		m_position[entry.node] = index;
+	}
+
+	void siftUp(int index, const Entry& entry);
+	void siftDown(int index, const Entry& entry);
+
+public:
+	void resize(int nodeCount) {
+		m_heap.clear();
+		m_position.assign(nodeCount, -1);
+	}
+
+	bool empty() const {
+		return m_heap.empty();
+	}
+
+	bool contains(int node) const {
+		return m_position[node] != -1;
+	}
+
+	int top() const {
+		return m_heap[0].node;
+	}
+
+	Key topKey() const {
+		return m_heap[0].key;
+	}
+
+	void set(int node, const Key& key);
+	void remove(int node);
+};
+
+// ----------------------------------------------------------------
+//  Name:           set
+//  Description:    Queues a node, or moves it if it is already
+//                  queued.
+//  Arguments:      The node and its new key.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType>
+void IncrementalQueue<NodeType>::set(int node, const Key& key) {
+	Entry entry = { key, node };
+	int index = m_position[node];
+	if (index == -1) {
+		m_heap.push_back(entry);
+		siftUp((int)m_heap.size() - 1, entry);
+	}
+	else if (key < m_heap[index].key) {
+		siftUp(index, entry);
+	}
+	else {
+		siftDown(index, entry);
+	}
+}
+
+template<class NodeType>
+void IncrementalQueue<NodeType>::remove(int node) {
+	int index = m_position[node];
+	if (index == -1)
+		return;
+	m_position[node] = -1;
+	Entry last = m_heap.back();
+	m_heap.pop_back();
+	if (index < (int)m_heap.size()) {
+		// the last entry fills the hole and may have to go either way
+		if (index > 0 && last.key < m_heap[(index - 1) / 2].key)
+			siftUp(index, last);
+		else
+			siftDown(index, last);
+	}
+}
+
+template<class NodeType>
+void IncrementalQueue<NodeType>::siftUp(int index, const Entry& entry) {
+	while (index > 0) {
+		int parent = (index - 1) / 2;
+		if ((entry.key < m_heap[parent].key) == false)
+			break;
+		place(index, m_heap[parent]);
+		index = parent;
+	}
+	place(index, entry);
+}
+
+template<class NodeType>
+void IncrementalQueue<NodeType>::siftDown(int index, const Entry& entry) {
+	int count = (int)m_heap.size();
+	for (;;) {
+		int child = (index * 2) + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count && m_heap[child + 1].key < m_heap[child].key)
+			child++;
+		if ((m_heap[child].key < entry.key) == false)
+			break;
+		place(index, m_heap[child]);
+		index = child;
+	}
+	place(index, entry);
+}
+
+// ----------------------------------------------------------------
+//  Name:           IncrementalPlanner
+//  Description:    The part shared by LPA* and D* Lite. Every node
+//                  keeps g, its cost from the search root as last
+//                  expanded, and rhs, the best cost its neighbours
+//                  offer now. Nodes where the two differ are queued
+//                  and only those are expanded, so after a change
+//                  the search repairs the costs it affects instead
+//                  of starting over. The state lives in the planner
+//                  between calls.
+//
+//                  Backward is false for LPA*, which searches from
+//                  the start, and true for D* Lite, which searches
+//                  back from the destination so the start can move.
+//
+//                  The snapshot is held by reference. After editing
+//                  the graph, freeze it into the same snapshot
+//                  object and report every changed arc with
+//                  arcChanged().
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, bool Backward>
+class IncrementalPlanner {
+protected:
+	typedef IncrementalKey<NodeType> Key;
+
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+	std::vector<NodeType> m_g;
+	std::vector<NodeType> m_rhs;
+	IncrementalQueue<NodeType> m_queue;
+
+// ----------------------------------------------------------------
+//  Description:    The node the search grows from and the node it
+//                  has to reach. For D* Lite the target is the
+//                  agent's position, which moves; m_offset (km)
+//                  keeps the keys already queued valid when it does.
+// ----------------------------------------------------------------
+	int m_root;
+	int m_target;
+	NodeType m_offset;
+	int m_expanded;
+
+	static const NodeType INFINITE_COST;
+
+	void initialise(int root, int target);
+	Key key(int node) const;
+	void updateNode(int node);
+	void computeShortestPath();
+	void tracePath(std::vector<int>& path) const;
+
+	// arcs walked away from the root, and arcs walked towards it
+	template<class Visitor>
+	void forEachOutward(int node, Visitor visit) const {
+		if (Backward)
+			m_graph.forEachReverseArc(node, visit);
+		else
+			m_graph.forEachArc(node, visit);
+	}
+
+	template<class Visitor>
+	void forEachInward(int node, Visitor visit) const {
+		if (Backward)
+			m_graph.forEachArc(node, visit);
+		else
+			m_graph.forEachReverseArc(node, visit);
+	}
+
+	NodeType heuristic(int node) const {
+		return Backward ? m_graph.heuristic(m_target, node) : m_graph.heuristic(node, m_target);
+	}
+
+	bool initialised() const {
+		return m_root != -1 && (int)m_g.size() == m_graph.nodeCount();
+	}
+
+public:
+	IncrementalPlanner(const GraphCSR<NodeType, ArcType>& graph) :
+	m_graph(graph),
+	m_root(-1),
+	m_target(-1),
+	m_offset(),
+	m_expanded(0) {
+	}
+
+	void arcChanged(int from, int to);
+
+// ----------------------------------------------------------------
+//  Name:           expanded
+//  Description:    Nodes expanded by the last call to plan, a
+//                  measure of how much work the repair took.
+// ----------------------------------------------------------------
+	int expanded() const {
+		return m_expanded;
+	}
+};
+
+template<class NodeType, class ArcType, bool Backward>
+const NodeType IncrementalPlanner<NodeType, ArcType, Backward>::INFINITE_COST = std::numeric_limits<NodeType>::max();
+
+template<class NodeType, class ArcType, bool Backward>
+void IncrementalPlanner<NodeType, ArcType, Backward>::initialise(int root, int target) {
+	int count = m_graph.nodeCount();
+	m_g.assign(count, INFINITE_COST);
+	m_rhs.assign(count, INFINITE_COST);
+	m_queue.resize(count);
+	m_root = root;
+	m_target = target;
+	m_offset = NodeType();
+	m_rhs[root] = NodeType();
+	m_queue.set(root, key(root));
+}
+
+template<class NodeType, class ArcType, bool Backward>
+IncrementalKey<NodeType> IncrementalPlanner<NodeType, ArcType, Backward>::key(int node) const {
+	NodeType cost = std::min(m_g[node], m_rhs[node]);
+	if (cost == INFINITE_COST)
+		return Key(INFINITE_COST, INFINITE_COST);
+	return Key(cost + heuristic(node) + m_offset, cost);
+}
+
+// ----------------------------------------------------------------
+//  Name:           updateNode
+//  Description:    Recomputes rhs of a node from its neighbours
+//                  nearer the root, and queues it only if it is now
+//                  inconsistent (g != rhs).
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, bool Backward>
+void IncrementalPlanner<NodeType, ArcType, Backward>::updateNode(int node) {
+	if (node != m_root) {
+		NodeType best = INFINITE_COST;
+		forEachInward(node, [&](int other, ArcType weight) {
+			if (m_g[other] != INFINITE_COST && m_g[other] + weight < best)
+				best = m_g[other] + weight;
+		});
+		m_rhs[node] = best;
+	}
+	if (m_g[node] != m_rhs[node])
+		m_queue.set(node, key(node));
+	else
+		m_queue.remove(node);
+}
+
+// ----------------------------------------------------------------
+//  Name:           computeShortestPath
+//  Description:    Expands inconsistent nodes in key order until
+//                  the target's cost is settled. A node whose cost
+//                  dropped is made consistent and passes the drop
+//                  on; a node whose cost rose is reset to infinity
+//                  and it and its neighbours are recomputed.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, bool Backward>
+void IncrementalPlanner<NodeType, ArcType, Backward>::computeShortestPath() {
+	m_expanded = 0;
+	while (m_queue.empty() == false &&
+		(m_queue.topKey() < key(m_target) || m_rhs[m_target] != m_g[m_target])) {
+		int node = m_queue.top();
+		Key oldKey = m_queue.topKey();
+		Key newKey = key(node);
+		if (oldKey < newKey) {
+			// queued before the target moved
+			m_queue.set(node, newKey);
+			continue;
+		}
+
+		m_expanded++;
+		auto update = [&](int other, ArcType) {
+			updateNode(other);
+		};
+		if (m_rhs[node] < m_g[node]) {
+			m_g[node] = m_rhs[node];
+			m_queue.remove(node);
+			forEachOutward(node, update);
+		}
+		else {
+			m_g[node] = INFINITE_COST;
+			updateNode(node);
+			forEachOutward(node, update);
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           arcChanged
+//  Description:    Tells the planner an arc was added, removed or
+//                  reweighted. Call it after refreezing, once per
+//                  changed arc; the repair happens on the next plan.
+//  Arguments:      The arc's source and target nodes.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, bool Backward>
+void IncrementalPlanner<NodeType, ArcType, Backward>::arcChanged(int from, int to) {
+	if (initialised() == false)
+		return;
+	int count = m_graph.nodeCount();
+	if (from < 0 || from >= count || to < 0 || to >= count)
+		return;
+	// only the end further from the root takes its cost over the arc
+	updateNode(Backward ? from : to);
+}
+
+// ----------------------------------------------------------------
+//  Name:           tracePath
+//  Description:    Walks from the target back to the root, each
+//                  time to the neighbour the target's cost came
+//                  through, and writes the path in travel order.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, bool Backward>
+void IncrementalPlanner<NodeType, ArcType, Backward>::tracePath(std::vector<int>& path) const {
+	path.clear();
+	int node = m_target;
+	path.push_back(node);
+	while (node != m_root && (int)path.size() <= m_graph.nodeCount()) {
+		int next = -1;
+		NodeType best = INFINITE_COST;
+		forEachInward(node, [&](int other, ArcType weight) {
+			if (m_g[other] != INFINITE_COST && m_g[other] + weight < best) {
+				best = m_g[other] + weight;
+				next = other;
+			}
+		});
+		if (next == -1)
+			break;
+		node = next;
+		path.push_back(node);
+	}
+	// LPA* traced dest back to start; D* Lite already went start to dest
+	if (Backward == false)
+		std::reverse(path.begin(), path.end());
+}
+
+// ----------------------------------------------------------------
+//  Name:           LPAStar
+//  Description:    Lifelong Planning A*: repeated searches between
+//                  a fixed start and destination as arcs change.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class LPAStar : public IncrementalPlanner<NodeType, ArcType, false> {
+private:
+	typedef IncrementalPlanner<NodeType, ArcType, false> Base;
+
+public:
+	LPAStar(const GraphCSR<NodeType, ArcType>& graph) : Base(graph) {}
+
+	bool plan(int start, int dest, std::vector<int>& path);
+};
+
+// ----------------------------------------------------------------
+//  Name:           plan
+//  Description:    Brings the costs up to date and returns the
+//                  path. A new start or destination, or a snapshot
+//                  with a different node count, starts afresh.
+//  Arguments:      The start and destination node indices and the
+//                  vector the path (start to dest) is written to.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool LPAStar<NodeType, ArcType>::plan(int start, int dest, std::vector<int>& path) {
+	int count = this->m_graph.nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+	if (this->initialised() == false || start != this->m_root || dest != this->m_target)
+		this->initialise(start, dest);
+
+	this->computeShortestPath();
+	if (this->m_g[dest] == Base::INFINITE_COST)
+		return false;
+	this->tracePath(path);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           DStarLite
+//  Description:    D* Lite: like LPA* but searching back from the
+//                  destination, so an agent can replan from where
+//                  it is now after moving along the path.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class DStarLite : public IncrementalPlanner<NodeType, ArcType, true> {
+private:
+	typedef IncrementalPlanner<NodeType, ArcType, true> Base;
+
+public:
+	DStarLite(const GraphCSR<NodeType, ArcType>& graph) : Base(graph) {}
+
+	bool plan(int position, int dest, std::vector<int>& path);
+};
+
+// ----------------------------------------------------------------
+//  Name:           plan
+//  Description:    Brings the costs up to date for the agent's
+//                  current position and returns its path. A new
+//                  destination, or a snapshot with a different node
+//                  count, starts afresh; a new position does not.
+//  Arguments:      The agent's node, the destination node and the
+//                  vector the path (position to dest) is written to.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool DStarLite<NodeType, ArcType>::plan(int position, int dest, std::vector<int>& path) {
+	int count = this->m_graph.nodeCount();
+	if (position < 0 || position >= count || dest < 0 || dest >= count)
+		return false;
+	if (this->initialised() == false || dest != this->m_root) {
+		this->initialise(dest, position);
+	}
+	else if (position != this->m_target) {
+		// keys already queued were made for the old position; raise
+		// every new key by at most how far the heuristic can shift
+		this->m_offset += this->m_graph.heuristic(this->m_target, position);
+		this->m_target = position;
+	}
+
+	this->computeShortestPath();
+	if (this->m_g[position] == Base::INFINITE_COST)
+		return false;
+	this->tracePath(path);
+	return true;
+}
+
+#endif
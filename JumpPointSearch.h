@@ -0,0 +1,353 @@
+#ifndef JUMPPOINTSEARCH_H
+#define JUMPPOINTSEARCH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "OccupancyGrid.h"
+#include "SearchContext.h"
+
+// ----------------------------------------------------------------
+//  Name:           JumpPointSearch
+//  Description:    A* over a uniform cost, 8-connected occupancy
+//                  grid with symmetric paths pruned (Jump Point
+//                  Search). Instead of queueing every neighbour, a
+//                  node is followed in a straight line or diagonal
+//                  until something could change the best path - a
+//                  wall corner ("forced neighbour") or the
+//                  destination - and only that jump point is
+//                  queued. On open maps far fewer nodes reach the
+//                  open list.
+//
+//                  Diagonal steps may not cut corners: both cells
+//                  beside the step must be free.
+//
+//                  precompute() stores the jump distance of every
+//                  cell in all 8 directions (JPS+), so a search
+//                  reads one entry per direction instead of
+//                  scanning the grid. Changing the grid afterwards
+//                  needs another precompute().
+// ----------------------------------------------------------------
+template<class NodeType>
+class JumpPointSearch {
+private:
+	typedef GridMoveCosts<NodeType> Costs;
+
+	const OccupancyGrid& m_grid;
+
+// ----------------------------------------------------------------
+//  Description:    JPS+ table, 8 entries per cell in DIRECTION_X/Y
+//                  order. A positive entry is the number of steps
+//                  to the next jump point; otherwise minus the
+//                  number of free steps before a wall. Empty if
+//                  precompute() has not been called.
+// ----------------------------------------------------------------
+	std::vector<int> m_jumps;
+
+	static const int DIRECTION_X[8];
+	static const int DIRECTION_Y[8];
+
+	static int direction(int dx, int dy);
+	bool canStep(int x, int y, int dx, int dy) const;
+	bool forced(int x, int y, int dx, int dy) const;
+	int jump(int x, int y, int dx, int dy, int dest) const;
+	int jumpPlus(int x, int y, int dx, int dy, int dest) const;
+	NodeType heuristic(int node, int dest) const;
+
+public:
+	JumpPointSearch(const OccupancyGrid& grid) : m_grid(grid) {}
+
+	void precompute();
+
+	bool precomputed() const {
+		return m_jumps.empty() == false;
+	}
+
+	template<class OpenList>
+	bool aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const;
+};
+
+// straight directions first; precompute() relies on it
+template<class NodeType>
+const int JumpPointSearch<NodeType>::DIRECTION_X[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+template<class NodeType>
+const int JumpPointSearch<NodeType>::DIRECTION_Y[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+template<class NodeType>
+int JumpPointSearch<NodeType>::direction(int dx, int dy) {
+	for (int d = 0; d < 8; d++) {
+		if (DIRECTION_X[d] == dx && DIRECTION_Y[d] == dy)
+			return d;
+	}
+	return -1;
+}
+
+// true if one step from (x, y) in the direction is allowed
+template<class NodeType>
+bool JumpPointSearch<NodeType>::canStep(int x, int y, int dx, int dy) const {
+	if (dx != 0 && dy != 0 && (m_grid.passable(x + dx, y) == false || m_grid.passable(x, y + dy) == false))
+		return false;
+	return m_grid.passable(x + dx, y + dy);
+}
+
+// ----------------------------------------------------------------
+//  Name:           forced
+//  Description:    True if a cell reached by a straight move has a
+//                  forced neighbour: a free cell beside it whose
+//                  own neighbour behind is blocked, so the only
+//                  short way into it is through this cell.
+// ----------------------------------------------------------------
+template<class NodeType>
+bool JumpPointSearch<NodeType>::forced(int x, int y, int dx, int dy) const {
+	if (dx != 0) {
+		return (m_grid.passable(x, y - 1) && m_grid.passable(x - dx, y - 1) == false) ||
+			(m_grid.passable(x, y + 1) && m_grid.passable(x - dx, y + 1) == false);
+	}
+	return (m_grid.passable(x - 1, y) && m_grid.passable(x - 1, y - dy) == false) ||
+		(m_grid.passable(x + 1, y) && m_grid.passable(x + 1, y - dy) == false);
+}
+
+// ----------------------------------------------------------------
+//  Name:           jump
+//  Description:    Steps from a cell in one direction until it
+//                  reaches a jump point. A diagonal step is a jump
+//                  point when a straight jump along either of its
+//                  components finds one.
+//  Arguments:      The cell, the direction and the destination.
+//  Return Value:   The jump point's index, or -1 if a wall comes
+//                  first.
+// ----------------------------------------------------------------
+template<class NodeType>
+int JumpPointSearch<NodeType>::jump(int x, int y, int dx, int dy, int dest) const {
+	for (;;) {
+		if (canStep(x, y, dx, dy) == false)
+			return -1;
+		x += dx;
+		y += dy;
+		int cell = m_grid.index(x, y);
+		if (cell == dest)
+			return cell;
+		if (dx != 0 && dy != 0) {
+			if (jump(x, y, dx, 0, dest) != -1 || jump(x, y, 0, dy, dest) != -1)
+				return cell;
+		}
+		else if (forced(x, y, dx, dy)) {
+			return cell;
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           jumpPlus
+//  Description:    jump() using the precomputed distances. The
+//                  table knows nothing of the destination, so this
+//                  checks whether dest lies ahead first: on the
+//                  line for a straight move, or in the row or
+//                  column the diagonal crosses, in which case the
+//                  crossing cell is returned and the straight move
+//                  from there finds dest.
+// ----------------------------------------------------------------
+template<class NodeType>
+int JumpPointSearch<NodeType>::jumpPlus(int x, int y, int dx, int dy, int dest) const {
+	int distance = m_jumps[(size_t)m_grid.index(x, y) * 8 + direction(dx, dy)];
+	int reach = std::abs(distance);
+	int destX = dest % m_grid.width();
+	int destY = dest / m_grid.width();
+	int offsetX = destX - x;
+	int offsetY = destY - y;
+
+	if (dx != 0 && dy != 0) {
+		if (offsetX * dx > 0 && offsetY * dy > 0) {
+			int steps = std::min(std::abs(offsetX), std::abs(offsetY));
+			if (steps <= reach)
+				return m_grid.index(x + (steps * dx), y + (steps * dy));
+		}
+	}
+	else if (dx != 0) {
+		if (offsetY == 0 && offsetX * dx > 0 && std::abs(offsetX) <= reach)
+			return dest;
+	}
+	else if (offsetX == 0 && offsetY * dy > 0 && std::abs(offsetY) <= reach) {
+		return dest;
+	}
+
+	if (distance <= 0)
+		return -1;
+	return m_grid.index(x + (distance * dx), y + (distance * dy));
+}
+
+// ----------------------------------------------------------------
+//  Name:           precompute
+//  Description:    Fills the JPS+ table. Each direction is swept
+//                  so the next cell along it is always done first,
+//                  which makes a cell's entry one step more than
+//                  its neighbour's. Straight directions come
+//                  before diagonals, which read them.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType>
+void JumpPointSearch<NodeType>::precompute() {
+	int width = m_grid.width();
+	int height = m_grid.height();
+	m_jumps.assign((size_t)m_grid.cellCount() * 8, 0);
+
+	for (int d = 0; d < 8; d++) {
+		int dx = DIRECTION_X[d];
+		int dy = DIRECTION_Y[d];
+		for (int row = 0; row < height; row++) {
+			int y = dy > 0 ? height - 1 - row : row;
+			for (int column = 0; column < width; column++) {
+				int x = dx > 0 ? width - 1 - column : column;
+				if (m_grid.passable(x, y) == false || canStep(x, y, dx, dy) == false)
+					continue;
+
+				int nextX = x + dx;
+				int nextY = y + dy;
+				size_t next = (size_t)m_grid.index(nextX, nextY) * 8;
+				bool jumpPoint;
+				if (dx != 0 && dy != 0)
+					jumpPoint = m_jumps[next + direction(dx, 0)] > 0 || m_jumps[next + direction(0, dy)] > 0;
+				else
+					jumpPoint = forced(nextX, nextY, dx, dy);
+
+				int distance = 1;
+				if (jumpPoint == false) {
+					int after = m_jumps[next + d];
+					distance = after > 0 ? after + 1 : after - 1;
+				}
+				m_jumps[(size_t)m_grid.index(x, y) * 8 + d] = distance;
+			}
+		}
+	}
+}
+
+// octile distance: diagonal steps for the shorter axis, straight for the rest
+template<class NodeType>
+NodeType JumpPointSearch<NodeType>::heuristic(int node, int dest) const {
+	int width = m_grid.width();
+	int dx = std::abs((node % width) - (dest % width));
+	int dy = std::abs((node / width) - (dest / width));
+	int diagonal = std::min(dx, dy);
+	return (NodeType)(Costs::diagonal() * diagonal + Costs::straight() * (std::max(dx, dy) - diagonal));
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    Jump Point Search between two cells, using the
+//                  JPS+ table if precompute() has been called.
+//  Arguments:      The start and destination cell indices, the
+//                  vector the path is written to and the search
+//                  context, which is reset first.
+//  Return Value:   true if a path was found. The path lists every
+//                  cell from start to dest, not just jump points.
+// ----------------------------------------------------------------
+template<class NodeType>
+template<class OpenList>
+bool JumpPointSearch<NodeType>::aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const {
+	typedef SearchContext<NodeType, OpenList> Context;
+
+	int count = m_grid.cellCount();
+	int width = m_grid.width();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+	if (m_grid.passable(start % width, start / width) == false || m_grid.passable(dest % width, dest / width) == false)
+		return false;
+	if (context.size() < count)
+		context.resize(count);
+	context.reset();
+
+	typename Context::OpenListType& open = context.openList();
+	context.setState(start, Context::OPEN);
+	context.setGCost(start, NodeType());
+	context.setHCost(start, heuristic(start, dest));
+	open.push(start, context.fCost(start), NodeType());
+
+	bool found = false;
+	int directions[8];
+	while (open.empty() == false) {
+		int current = open.pop();
+		if (context.state(current) == Context::CLOSED)
+			continue;
+		context.setState(current, Context::CLOSED);
+		if (current == dest) {
+			found = true;
+			break;
+		}
+
+		int x = current % width;
+		int y = current / width;
+		int directionCount = 0;
+		int parent = context.previous(current);
+		if (parent == -1) {
+			for (int d = 0; d < 8; d++)
+				directions[directionCount++] = d;
+		}
+		else {
+			// carry on the way we came, plus any forced turns
+			int dx = (x > parent % width) - (x < parent % width);
+			int dy = (y > parent / width) - (y < parent / width);
+			directions[directionCount++] = direction(dx, dy);
+			if (dx != 0 && dy != 0) {
+				directions[directionCount++] = direction(dx, 0);
+				directions[directionCount++] = direction(0, dy);
+			}
+			else if (dx != 0) {
+				for (int side = -1; side <= 1; side += 2) {
+					if (m_grid.passable(x, y + side) && m_grid.passable(x - dx, y + side) == false) {
+						directions[directionCount++] = direction(0, side);
+						directions[directionCount++] = direction(dx, side);
+					}
+				}
+			}
+			else {
+				for (int side = -1; side <= 1; side += 2) {
+					if (m_grid.passable(x + side, y) && m_grid.passable(x + side, y - dy) == false) {
+						directions[directionCount++] = direction(side, 0);
+						directions[directionCount++] = direction(side, dy);
+					}
+				}
+			}
+		}
+
+		NodeType currentG = context.gCost(current);
+		for (int i = 0; i < directionCount; i++) {
+			int dx = DIRECTION_X[directions[i]];
+			int dy = DIRECTION_Y[directions[i]];
+			int child = precomputed() ? jumpPlus(x, y, dx, dy, dest) : jump(x, y, dx, dy, dest);
+			if (child == -1 || context.state(child) == Context::CLOSED)
+				continue;
+
+			int steps = std::max(std::abs((child % width) - x), std::abs((child / width) - y));
+			NodeType Gc = currentG + (NodeType)(steps * ((dx != 0 && dy != 0) ? Costs::diagonal() : Costs::straight()));
+			if (context.state(child) == Context::UNVISITED)
+				context.setHCost(child, heuristic(child, dest));
+			else if (Gc >= context.gCost(child))
+				continue;
+			context.setState(child, Context::OPEN);
+			context.setGCost(child, Gc);
+			context.setPrevious(child, current);
+			open.push(child, Gc + context.hCost(child), Gc);
+		}
+	}
+
+	if (found == false)
+		return false;
+
+	// walk each jump back to its parent one cell at a time
+	path.clear();
+	for (int node = dest; node != start; node = context.previous(node)) {
+		int parent = context.previous(node);
+		int px = parent % width;
+		int py = parent / width;
+		int dx = (px > node % width) - (px < node % width);
+		int dy = (py > node / width) - (py < node / width);
+		for (int x = node % width, y = node / width; x != px || y != py; x += dx, y += dy)
+			path.push_back(m_grid.index(x, y));
+	}
+	path.push_back(start);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+#endif
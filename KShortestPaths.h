@@ -0,0 +1,365 @@
+#ifndef KSHORTESTPATHS_H
+#define KSHORTESTPATHS_H
+
+#include <vector>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+
+// ----------------------------------------------------------------
+//  Name:           KShortestPaths
+//  Description:    The k cheapest loopless paths between two nodes
+//                  (Yen), for offering alternative routes. Each
+//                  path after the first leaves an earlier one at
+//                  some spur node: the part before the spur (the
+//                  root) is kept and the rest is searched for again
+//                  with the root's nodes, and the arcs earlier paths
+//                  took out of the spur node, masked out. Masks are
+//                  generation stamps held here, so the graph itself
+//                  is never changed and can be shared.
+//
+//                  One Dijkstra search backwards from dest builds a
+//                  shortest path tree at the start, which is reused
+//                  by every spur search:
+//                      - the first path is read off it directly;
+//                      - its costs to dest are the spur searches'
+//                        heuristic, exact wherever the masks do not
+//                        get in the way;
+//                      - a spur search stops at the first node it
+//                        takes off the open list whose tree path to
+//                        dest avoids every masked node and arc, as
+//                        that tree path finishes the cheapest route.
+//                  So most spur searches expand a handful of nodes.
+//                  Spur nodes before the point where a path left
+//                  its parent are skipped (Lawler), as they only
+//                  give paths that were already found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class KShortestPaths {
+private:
+	typedef SearchContext<NodeType> Context;
+
+// ----------------------------------------------------------------
+//  Description:    A found or candidate path. costs[i] is the cost
+//                  from the start to nodes[i]. The path left the
+//                  one it was found from at nodes[deviation].
+// ----------------------------------------------------------------
+	struct Route {
+		std::vector<int> nodes;
+		std::vector<NodeType> costs;
+		int deviation;
+	};
+
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+// ----------------------------------------------------------------
+//  Description:    The backward search from dest. Once it is done
+//                  every node that can reach dest is closed, with
+//                  gCost its cost to dest and previous the next
+//                  node on the way.
+// ----------------------------------------------------------------
+	Context m_tree;
+	Context m_spur;
+
+	std::vector<Route> m_found;
+	std::vector<Route> m_candidates;
+
+// ----------------------------------------------------------------
+//  Description:    Per spur search masks, current while they carry
+//                  m_stamp: the root's nodes, and which nodes have
+//                  a tree path clear of every mask (m_clear holds
+//                  the answer).
+// ----------------------------------------------------------------
+	std::vector<unsigned int> m_blocked;
+	std::vector<unsigned int> m_checked;
+	std::vector<bool> m_clear;
+	std::vector<int> m_blockedHeads;
+	std::vector<int> m_walk;
+	unsigned int m_stamp;
+
+	int m_spurSearches;
+	int m_expanded;
+
+	void buildTree(int dest);
+	void nextStamp();
+	bool treePathClear(int node, int spur);
+	void spurSearch(const Route& route, int spurIndex);
+	bool known(const Route& route) const;
+
+public:
+	KShortestPaths(const GraphCSR<NodeType, ArcType>& graph) :
+	m_graph(graph),
+	m_stamp(0),
+	m_spurSearches(0),
+	m_expanded(0) {
+	}
+
+	bool search(int start, int dest, int k, std::vector<std::vector<int> >& paths, std::vector<NodeType>& costs);
+
+    // Accessors
+	int spurSearches() const {
+		return m_spurSearches;
+	}
+
+	int expanded() const {
+		return m_expanded;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Finds up to k loopless paths in order of cost.
+//  Arguments:      The start and destination node indices, how
+//                  many paths are wanted, and the vectors the paths
+//                  (start to dest) and their costs are written to.
+//                  Fewer than k paths come back if there are no
+//                  more.
+//  Return Value:   true if at least one path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool KShortestPaths<NodeType, ArcType>::search(int start, int dest, int k, std::vector<std::vector<int> >& paths, std::vector<NodeType>& costs) {
+	int count = m_graph.nodeCount();
+	paths.clear();
+	costs.clear();
+	m_found.clear();
+	m_candidates.clear();
+	m_spurSearches = 0;
+	m_expanded = 0;
+	if (start < 0 || start >= count || dest < 0 || dest >= count || k <= 0)
+		return false;
+
+	if (m_tree.size() < count) {
+		m_tree.resize(count);
+		m_spur.resize(count);
+		m_blocked.assign(count, 0);
+		m_checked.assign(count, 0);
+		m_clear.assign(count, false);
+		m_stamp = 0;
+	}
+	buildTree(dest);
+	if (m_tree.state(start) != Context::CLOSED)
+		return false;
+
+	Route first;
+	for (int node = start; node != -1; node = m_tree.previous(node)) {
+		first.nodes.push_back(node);
+		first.costs.push_back(m_tree.gCost(start) - m_tree.gCost(node));
+	}
+	first.deviation = 0;
+	m_found.push_back(first);
+
+	while ((int)m_found.size() < k) {
+		const Route& last = m_found.back();
+		for (int i = last.deviation; i + 1 < (int)last.nodes.size(); i++)
+			spurSearch(last, i);
+		if (m_candidates.empty())
+			break;
+
+		size_t best = 0;
+		for (size_t i = 1; i < m_candidates.size(); i++) {
+			if (m_candidates[i].costs.back() < m_candidates[best].costs.back())
+				best = i;
+		}
+		m_found.push_back(m_candidates[best]);
+		m_candidates[best] = m_candidates.back();
+		m_candidates.pop_back();
+	}
+
+	for (const Route& route : m_found) {
+		paths.push_back(route.nodes);
+		costs.push_back(route.costs.back());
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildTree
+//  Description:    Dijkstra over the reversed arcs from dest,
+//                  settling every node that can reach it.
+//  Arguments:      The destination node index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void KShortestPaths<NodeType, ArcType>::buildTree(int dest) {
+	typename Context::OpenListType& open = m_tree.openList();
+	m_tree.reset();
+	m_tree.setState(dest, Context::OPEN);
+	m_tree.setGCost(dest, NodeType());
+	open.push(dest, NodeType(), NodeType());
+
+	while (open.empty() == false) {
+		int node = open.pop();
+		if (m_tree.state(node) == Context::CLOSED)
+			continue;
+		m_tree.setState(node, Context::CLOSED);
+		NodeType nodeG = m_tree.gCost(node);
+
+		m_graph.forEachReverseArc(node, [&](int child, ArcType weight) {
+			NodeType Gc = nodeG + weight;
+			typename Context::NodeState state = m_tree.state(child);
+			if (state == Context::UNVISITED || (state == Context::OPEN && Gc < m_tree.gCost(child))) {
+				m_tree.setState(child, Context::OPEN);
+				m_tree.setGCost(child, Gc);
+				m_tree.setPrevious(child, node);
+				open.push(child, Gc, Gc);
+			}
+		});
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           nextStamp
+//  Description:    Clears the masks of the last spur search.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void KShortestPaths<NodeType, ArcType>::nextStamp() {
+	m_stamp++;
+	if (m_stamp == 0) {
+		std::fill(m_blocked.begin(), m_blocked.end(), 0);
+		std::fill(m_checked.begin(), m_checked.end(), 0);
+		m_stamp = 1;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           treePathClear
+//  Description:    Whether the tree path from a node to dest is
+//                  usable in the current spur search: it must not
+//                  pass through the root, nor come back to the spur
+//                  node, nor (from the spur node itself) take a
+//                  masked arc. Answers are kept for the rest of the
+//                  spur search, so each node's path is walked once.
+//  Arguments:      The node, which can reach dest, and the spur
+//                  node.
+//  Return Value:   true if the tree path is clear.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool KShortestPaths<NodeType, ArcType>::treePathClear(int node, int spur) {
+	if (node == spur) {
+		int next = m_tree.previous(spur);
+		if (std::find(m_blockedHeads.begin(), m_blockedHeads.end(), next) != m_blockedHeads.end())
+			return false;
+		return treePathClear(next, spur);
+	}
+
+	// walk until the answer is known, then write it back along the walk
+	bool clear = true;
+	m_walk.clear();
+	for (int at = node; ; at = m_tree.previous(at)) {
+		if (m_checked[at] == m_stamp) {
+			clear = m_clear[at];
+			break;
+		}
+		if (at == spur || m_blocked[at] == m_stamp) {
+			clear = false;
+			break;
+		}
+		m_walk.push_back(at);
+		if (m_tree.previous(at) == -1)
+			break;
+	}
+	for (int at : m_walk) {
+		m_checked[at] = m_stamp;
+		m_clear[at] = clear;
+	}
+	return clear;
+}
+
+// ----------------------------------------------------------------
+//  Name:           spurSearch
+//  Description:    A* from one node of a found path to dest, with
+//                  the root before it and the arcs earlier paths
+//                  with the same root took out of it masked. The
+//                  path found, root included, becomes a candidate
+//                  unless it is one already.
+//  Arguments:      The found path and the index of the spur node
+//                  on it.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void KShortestPaths<NodeType, ArcType>::spurSearch(const Route& route, int spurIndex) {
+	int spur = route.nodes[spurIndex];
+	nextStamp();
+	for (int i = 0; i < spurIndex; i++)
+		m_blocked[route.nodes[i]] = m_stamp;
+	m_blockedHeads.clear();
+	for (const Route& found : m_found) {
+		if ((int)found.nodes.size() > spurIndex + 1 && std::equal(route.nodes.begin(), route.nodes.begin() + spurIndex + 1, found.nodes.begin()))
+			m_blockedHeads.push_back(found.nodes[spurIndex + 1]);
+	}
+	m_spurSearches++;
+
+	typename Context::OpenListType& open = m_spur.openList();
+	m_spur.reset();
+	m_spur.setState(spur, Context::OPEN);
+	m_spur.setGCost(spur, NodeType());
+	open.push(spur, m_tree.gCost(spur), NodeType());
+
+	int meet = -1;
+	while (open.empty() == false) {
+		int current = open.pop();
+		if (m_spur.state(current) == Context::CLOSED)
+			continue;
+		m_spur.setState(current, Context::CLOSED);
+		if (treePathClear(current, spur)) {
+			meet = current;
+			break;
+		}
+		m_expanded++;
+
+		NodeType currentG = m_spur.gCost(current);
+		m_graph.forEachArc(current, [&](int child, ArcType weight) {
+			// nodes that cannot reach dest are no use
+			if (m_blocked[child] == m_stamp || m_tree.state(child) != Context::CLOSED)
+				return;
+			if (current == spur && std::find(m_blockedHeads.begin(), m_blockedHeads.end(), child) != m_blockedHeads.end())
+				return;
+			typename Context::NodeState state = m_spur.state(child);
+			NodeType Gc = currentG + weight;
+			if (state == Context::CLOSED || (state == Context::OPEN && Gc >= m_spur.gCost(child)))
+				return;
+			m_spur.setState(child, Context::OPEN);
+			m_spur.setGCost(child, Gc);
+			m_spur.setPrevious(child, current);
+			open.push(child, Gc + m_tree.gCost(child), Gc);
+		});
+	}
+	if (meet == -1)
+		return;
+
+	Route candidate;
+	candidate.deviation = spurIndex;
+	candidate.nodes.assign(route.nodes.begin(), route.nodes.begin() + spurIndex);
+	candidate.costs.assign(route.costs.begin(), route.costs.begin() + spurIndex);
+	NodeType rootCost = route.costs[spurIndex];
+	for (int node = meet; node != -1; node = m_spur.previous(node)) {
+		candidate.nodes.push_back(node);
+		candidate.costs.push_back(rootCost + m_spur.gCost(node));
+	}
+	std::reverse(candidate.nodes.begin() + spurIndex, candidate.nodes.end());
+	std::reverse(candidate.costs.begin() + spurIndex, candidate.costs.end());
+	NodeType meetCost = candidate.costs.back();
+	for (int node = m_tree.previous(meet); node != -1; node = m_tree.previous(node)) {
+		candidate.nodes.push_back(node);
+		candidate.costs.push_back(meetCost + m_tree.gCost(meet) - m_tree.gCost(node));
+	}
+
+	if (known(candidate) == false)
+		m_candidates.push_back(candidate);
+}
+
+// ----------------------------------------------------------------
+//  Name:           known
+//  Description:    Whether a path is already a candidate; different
+//                  spur searches can find the same one.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool KShortestPaths<NodeType, ArcType>::known(const Route& route) const {
+	for (const Route& candidate : m_candidates) {
+		if (candidate.nodes == route.nodes)
+			return true;
+	}
+	return false;
+}
+
+#endif
@@ -0,0 +1,350 @@
+#ifndef LANDMARKHEURISTIC_H
+#define LANDMARKHEURISTIC_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <iostream>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+#include "AStarSearch.h"
+
+// ----------------------------------------------------------------
+//  Name:           LandmarkTable
+//  Description:    Precomputed distances for the ALT heuristic
+//                  (A*, Landmarks, Triangle inequality). For a few
+//                  landmark nodes L it stores d(L, v) and d(v, L)
+//                  for every node v. The triangle inequality then
+//                  gives a lower bound on d(v, t):
+//                      d(v, t) >= d(L, t) - d(L, v)
+//                      d(v, t) >= d(v, L) - d(t, L)
+//                  which holds whatever the arc weights mean, unlike
+//                  the straight line estimate.
+//
+//                  Tables are stored node by node so one lookup
+//                  reads all landmarks of a node together.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class LandmarkTable {
+private:
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+	std::vector<int> m_landmarks;
+
+// ----------------------------------------------------------------
+//  Description:    m_from[v * K + i] = d(landmark i, v) and
+//                  m_to[v * K + i] = d(v, landmark i), or UNREACHABLE.
+// ----------------------------------------------------------------
+	std::vector<NodeType> m_from;
+	std::vector<NodeType> m_to;
+
+	void computeDistances(int landmark, bool reverse, std::vector<NodeType>& table, SearchContext<NodeType>& context);
+	void header(int fields[7], int landmarkCount) const;
+
+public:
+	static const NodeType UNREACHABLE;
+
+	LandmarkTable(const GraphCSR<NodeType, ArcType>& graph) : m_graph(graph) {}
+
+	void build(int landmarkCount);
+	bool save(std::ostream& out) const;
+	bool load(std::istream& in);
+	NodeType heuristic(int node, int dest) const;
+
+	int landmarkCount() const {
+		return (int)m_landmarks.size();
+	}
+
+	std::vector<int> const & landmarks() const {
+		return m_landmarks;
+	}
+};
+
+template<class NodeType, class ArcType>
+const NodeType LandmarkTable<NodeType, ArcType>::UNREACHABLE = std::numeric_limits<NodeType>::max();
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Picks the landmarks and fills the tables. Each
+//                  new landmark is the node farthest from the ones
+//                  already picked, which spreads them around the
+//                  edge of the graph where they give the tightest
+//                  bounds. Runs two Dijkstra searches per landmark.
+//  Arguments:      The number of landmarks wanted.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void LandmarkTable<NodeType, ArcType>::build(int landmarkCount) {
+	int count = m_graph.nodeCount();
+	m_landmarks.clear();
+	m_from.assign((size_t)count * landmarkCount, UNREACHABLE);
+	m_to.assign((size_t)count * landmarkCount, UNREACHABLE);
+
+	// start from any node that has arcs
+	int seed = -1;
+	for (int node = 0; node < count && seed == -1; node++) {
+		if (m_graph.arcBegin(node) != m_graph.arcEnd(node))
+			seed = node;
+	}
+	if (seed == -1)
+		return;
+
+	// nearest[v] is the distance from the closest landmark so far; the
+	// seed stands in for one until the first landmark is placed
+	SearchContext<NodeType> context(count);
+	std::vector<NodeType> distance(count);
+	std::vector<NodeType> nearest(count);
+	computeDistances(seed, false, nearest, context);
+
+	for (int i = 0; i < landmarkCount; i++) {
+		int landmark = -1;
+		for (int node = 0; node < count; node++) {
+			if (nearest[node] != UNREACHABLE && (landmark == -1 || nearest[node] > nearest[landmark]))
+				landmark = node;
+		}
+		// stop when every reachable node is already a landmark
+		if (landmark == -1 || (i > 0 && nearest[landmark] == NodeType()))
+			break;
+		m_landmarks.push_back(landmark);
+
+		computeDistances(landmark, false, distance, context);
+		for (int node = 0; node < count; node++) {
+			m_from[(size_t)node * landmarkCount + i] = distance[node];
+			if (i == 0 || distance[node] < nearest[node])
+				nearest[node] = distance[node];
+		}
+
+		computeDistances(landmark, true, distance, context);
+		for (int node = 0; node < count; node++)
+			m_to[(size_t)node * landmarkCount + i] = distance[node];
+	}
+
+	// drop the columns of landmarks that could not be placed
+	int placed = (int)m_landmarks.size();
+	if (placed < landmarkCount) {
+		for (int node = 0; node < count; node++) {
+			for (int i = 0; i < placed; i++) {
+				m_from[(size_t)node * placed + i] = m_from[(size_t)node * landmarkCount + i];
+				m_to[(size_t)node * placed + i] = m_to[(size_t)node * landmarkCount + i];
+			}
+		}
+		m_from.resize((size_t)count * placed);
+		m_to.resize((size_t)count * placed);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           computeDistances
+//  Description:    Dijkstra from one node to every other node,
+//                  over the arcs or over the reversed arcs.
+//  Arguments:      The source node, true to follow arcs backwards,
+//                  the table to fill and a context to search with.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void LandmarkTable<NodeType, ArcType>::computeDistances(int landmark, bool reverse, std::vector<NodeType>& table, SearchContext<NodeType>& context) {
+	typedef SearchContext<NodeType> Context;
+
+	std::fill(table.begin(), table.end(), UNREACHABLE);
+	context.reset();
+	context.setState(landmark, Context::OPEN);
+	context.setGCost(landmark, NodeType());
+	context.openList().push(landmark, NodeType(), NodeType());
+
+	while (context.openList().empty() == false) {
+		int node = context.openList().pop();
+		if (context.state(node) == Context::CLOSED)
+			continue;
+		context.setState(node, Context::CLOSED);
+		NodeType nodeG = context.gCost(node);
+		table[node] = nodeG;
+
+		auto relax = [&](int child, ArcType weight) {
+			NodeType Gc = nodeG + weight;
+			if (context.state(child) == Context::UNVISITED || (context.state(child) == Context::OPEN && Gc < context.gCost(child))) {
+				context.setState(child, Context::OPEN);
+				context.setGCost(child, Gc);
+				context.openList().push(child, Gc, Gc);
+			}
+		};
+		if (reverse)
+			m_graph.forEachReverseArc(node, relax);
+		else
+			m_graph.forEachArc(node, relax);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           heuristic
+//  Description:    The largest triangle inequality bound over all
+//                  landmarks.
+//  Arguments:      The node and the destination node.
+//  Return Value:   A lower bound on the cost from node to dest.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType LandmarkTable<NodeType, ArcType>::heuristic(int node, int dest) const {
+	int k = (int)m_landmarks.size();
+	if (k == 0)
+		return NodeType();
+
+	const NodeType* fromNode = &m_from[0] + (size_t)node * k;
+	const NodeType* fromDest = &m_from[0] + (size_t)dest * k;
+	const NodeType* toNode = &m_to[0] + (size_t)node * k;
+	const NodeType* toDest = &m_to[0] + (size_t)dest * k;
+
+	NodeType best = NodeType();
+	for (int i = 0; i < k; i++) {
+		// d(L, dest) - d(L, node); only usable if L reaches both
+		if (fromDest[i] != UNREACHABLE && fromNode[i] != UNREACHABLE && fromDest[i] - fromNode[i] > best)
+			best = fromDest[i] - fromNode[i];
+		// d(node, L) - d(dest, L); only usable if both reach L
+		if (toNode[i] != UNREACHABLE && toDest[i] != UNREACHABLE && toNode[i] - toDest[i] > best)
+			best = toNode[i] - toDest[i];
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           header
+//  Description:    The file header save writes and load expects:
+//                  a magic number, the snapshot's node and arc
+//                  counts and weight journal version, the size of
+//                  NodeType and whether it is floating point, and
+//                  the landmark count.
+//  Arguments:      The seven fields to fill in and the landmark
+//                  count to put last.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void LandmarkTable<NodeType, ArcType>::header(int fields[7], int landmarkCount) const {
+	fields[0] = 0x544c41;
+	fields[1] = m_graph.nodeCount();
+	fields[2] = m_graph.arcCount();
+	fields[3] = (int)m_graph.version();
+	fields[4] = (int)sizeof(NodeType);
+	fields[5] = std::is_floating_point<NodeType>::value ? 1 : 0;
+	fields[6] = landmarkCount;
+}
+
+// ----------------------------------------------------------------
+//  Name:           save
+//  Description:    Writes the landmarks and tables in binary so a
+//                  later run can load them instead of rebuilding.
+//  Arguments:      The stream to write to (open it in binary mode).
+//  Return Value:   true on success.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool LandmarkTable<NodeType, ArcType>::save(std::ostream& out) const {
+	int fields[7];
+	header(fields, (int)m_landmarks.size());
+	out.write((const char*)fields, sizeof(fields));
+	if (m_landmarks.empty() == false) {
+		out.write((const char*)&m_landmarks[0], m_landmarks.size() * sizeof(int));
+		out.write((const char*)&m_from[0], m_from.size() * sizeof(NodeType));
+		out.write((const char*)&m_to[0], m_to.size() * sizeof(NodeType));
+	}
+	return out.good();
+}
+
+// ----------------------------------------------------------------
+//  Name:           load
+//  Description:    Reads tables written by save. Fails if they were
+//                  built for a snapshot with other node or arc
+//                  counts or another weight journal version, or
+//                  with another NodeType.
+//  Arguments:      The stream to read from (open it in binary mode).
+//  Return Value:   true on success; the table is left empty on
+//                  failure.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool LandmarkTable<NodeType, ArcType>::load(std::istream& in) {
+	int fields[7];
+	int expected[7];
+	m_landmarks.clear();
+	m_from.clear();
+	m_to.clear();
+
+	in.read((char*)fields, sizeof(fields));
+	header(expected, fields[6]);
+	if (in.good() == false || std::equal(fields, fields + 6, expected) == false || fields[6] < 0)
+		return false;
+
+	size_t entries = (size_t)fields[1] * fields[6];
+	m_landmarks.resize(fields[6]);
+	m_from.resize(entries);
+	m_to.resize(entries);
+	if (fields[6] > 0) {
+		in.read((char*)&m_landmarks[0], m_landmarks.size() * sizeof(int));
+		in.read((char*)&m_from[0], m_from.size() * sizeof(NodeType));
+		in.read((char*)&m_to[0], m_to.size() * sizeof(NodeType));
+	}
+	if (in.good() == false) {
+		m_landmarks.clear();
+		m_from.clear();
+		m_to.clear();
+		return false;
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           LandmarkAStar
+//  Description:    A* over a CSR snapshot guided by a landmark
+//                  table instead of the straight line estimate.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class LandmarkAStar {
+private:
+	const GraphCSR<NodeType, ArcType>& m_graph;
+	const LandmarkTable<NodeType, ArcType>& m_table;
+
+public:
+	LandmarkAStar(const GraphCSR<NodeType, ArcType>& graph, const LandmarkTable<NodeType, ArcType>& table) :
+	m_graph(graph),
+	m_table(table) {
+	}
+
+	// the graph concept aStarSearch expects
+	template<class Visitor>
+	void forEachArc(int node, Visitor visit) const {
+		m_graph.forEachArc(node, visit);
+	}
+
+	NodeType heuristic(int node, int dest) const {
+		return m_table.heuristic(node, dest);
+	}
+
+	template<class OpenList>
+	bool aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    Same as GraphCSR::aStar but with the landmark
+//                  heuristic.
+//  Arguments:      The start and destination node indices, the
+//                  vector the path is written to and the search
+//                  context, which is reset first.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool LandmarkAStar<NodeType, ArcType>::aStar(int start, int dest, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const {
+	int count = m_graph.nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+	if (context.size() < count)
+		context.resize(count);
+	context.reset();
+
+	if (aStarSearch(*this, start, dest, context) == false)
+		return false;
+
+	path.clear();
+	for (int node = dest; node != -1; node = context.previous(node))
+		path.push_back(node);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+#endif
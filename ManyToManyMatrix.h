@@ -0,0 +1,179 @@
+#ifndef MANYTOMANYMATRIX_H
+#define MANYTOMANYMATRIX_H
+
+#include <vector>
+#include "ContractionHierarchy.h"
+#include "SearchContext.h"
+#include "ParallelFor.h"
+
+// ----------------------------------------------------------------
+//  Name:           ManyToManyMatrix
+//  Description:    Cost matrices between a set of sources and a set
+//                  of targets over a contraction hierarchy, using
+//                  buckets instead of one query per pair.
+//
+//                  Every target runs one search up the hierarchy
+//                  over the downward arcs and leaves an entry
+//                  (target, cost) in a bucket at each node it
+//                  settles. Every source then runs one upward
+//                  search and, at each node it settles, scans that
+//                  node's bucket: source cost + bucket cost is a
+//                  candidate for that cell of the matrix. A shortest
+//                  path meets at its highest ranked node, which both
+//                  searches reach, so the minimum is exact.
+//
+//                  That is |sources| + |targets| small searches for
+//                  the whole matrix. Both phases are split over
+//                  threads, each with its own search context; the
+//                  sources write disjoint rows, so no locking is
+//                  needed.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class ManyToManyMatrix {
+private:
+	typedef ContractionHierarchy<NodeType, ArcType> Hierarchy;
+	typedef SearchContext<NodeType> Context;
+
+	struct BucketEntry {
+		int target;
+		NodeType cost;
+	};
+
+	struct Settled {
+		int node;
+		NodeType cost;
+	};
+
+	const Hierarchy& m_hierarchy;
+
+	template<class Visitor>
+	void upwardSearch(int start, bool forward, Context& context, Visitor visit) const;
+
+public:
+	ManyToManyMatrix(const Hierarchy& hierarchy) :
+	m_hierarchy(hierarchy) {
+	}
+
+	bool compute(const std::vector<int>& sources, const std::vector<int>& targets, std::vector<NodeType>& matrix, int threadCount = 0) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           upwardSearch
+//  Description:    Dijkstra from one node that only climbs in rank,
+//                  over the upward arcs (forward) or the downward
+//                  arcs in reverse (backward). The whole search
+//                  space is settled; visit(node, cost) is called
+//                  for every settled node.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Visitor>
+void ManyToManyMatrix<NodeType, ArcType>::upwardSearch(int start, bool forward, Context& context, Visitor visit) const {
+	context.reset();
+	typename Context::OpenListType& open = context.openList();
+	context.setState(start, Context::OPEN);
+	context.setGCost(start, NodeType());
+	open.push(start, NodeType(), NodeType());
+
+	while (open.empty() == false) {
+		int node = open.pop();
+		if (context.state(node) == Context::CLOSED)
+			continue;
+		context.setState(node, Context::CLOSED);
+		NodeType nodeG = context.gCost(node);
+		visit(node, nodeG);
+
+		auto relax = [&](int child, NodeType weight) {
+			NodeType Gc = nodeG + weight;
+			typename Context::NodeState state = context.state(child);
+			if (state == Context::UNVISITED || (state == Context::OPEN && Gc < context.gCost(child))) {
+				context.setState(child, Context::OPEN);
+				context.setGCost(child, Gc);
+				open.push(child, Gc, Gc);
+			}
+		};
+		if (forward)
+			m_hierarchy.forEachUpArc(node, relax);
+		else
+			m_hierarchy.forEachDownArc(node, relax);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           compute
+//  Description:    Fills the cost matrix. The hierarchy must have
+//                  been built.
+//  Arguments:      The source and target node indices, the vector
+//                  the matrix is written to and the number of
+//                  threads (0 uses one per hardware thread). The
+//                  matrix is sources.size() rows of targets.size()
+//                  costs in one contiguous block, so the cost from
+//                  sources[i] to targets[j] is
+//                      matrix[i * targets.size() + j]
+//                  and is -1 if there is no path.
+//  Return Value:   false if a node index is out of range.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool ManyToManyMatrix<NodeType, ArcType>::compute(const std::vector<int>& sources, const std::vector<int>& targets, std::vector<NodeType>& matrix, int threadCount) const {
+	int count = m_hierarchy.nodeCount();
+	int sourceCount = (int)sources.size();
+	int targetCount = (int)targets.size();
+	matrix.assign((size_t)sourceCount * targetCount, NodeType(-1));
+	if (sourceCount == 0 || targetCount == 0)
+		return true;
+	for (int source : sources) {
+		if (source < 0 || source >= count)
+			return false;
+	}
+	for (int target : targets) {
+		if (target < 0 || target >= count)
+			return false;
+	}
+	threadCount = threadCountOrDefault(threadCount);
+	std::vector<Context> contexts(threadCount);
+	for (Context& context : contexts)
+		context.resize(count);
+
+	// backward searches, kept per target so threads never share
+	std::vector<std::vector<Settled> > spaces(targetCount);
+	parallelFor(targetCount, threadCount, [&](int j, int thread) {
+		upwardSearch(targets[j], false, contexts[thread], [&](int node, NodeType cost) {
+			Settled settled = { node, cost };
+			spaces[j].push_back(settled);
+		});
+	});
+
+	// the search spaces sorted into one bucket per node
+	std::vector<int> offsets(count + 1, 0);
+	for (const std::vector<Settled>& space : spaces) {
+		for (const Settled& settled : space)
+			offsets[settled.node + 1]++;
+	}
+	for (int node = 0; node < count; node++)
+		offsets[node + 1] += offsets[node];
+	std::vector<BucketEntry> buckets(offsets[count]);
+	{
+		std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+		for (int j = 0; j < targetCount; j++) {
+			for (const Settled& settled : spaces[j]) {
+				BucketEntry entry = { j, settled.cost };
+				buckets[fill[settled.node]++] = entry;
+			}
+			std::vector<Settled>().swap(spaces[j]);
+		}
+	}
+
+	parallelFor(sourceCount, threadCount, [&](int i, int thread) {
+		NodeType* row = &matrix[(size_t)i * targetCount];
+		upwardSearch(sources[i], true, contexts[thread], [&](int node, NodeType cost) {
+			for (int entry = offsets[node]; entry < offsets[node + 1]; entry++) {
+				const BucketEntry& bucket = buckets[entry];
+				NodeType length = cost + bucket.cost;
+				if (row[bucket.target] == NodeType(-1) || length < row[bucket.target])
+					row[bucket.target] = length;
+			}
+		});
+	});
+	return true;
+}
+
+#endif
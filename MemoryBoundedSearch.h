@@ -0,0 +1,545 @@
+#ifndef MEMORYBOUNDEDSEARCH_H
+#define MEMORYBOUNDEDSEARCH_H
+
+#include <vector>
+#include <set>
+#include <limits>
+#include <algorithm>
+#include "GraphCSR.h"
+
+// ----------------------------------------------------------------
+//  Name:           IDAStar
+//  Description:    Iterative deepening A*. Depth first searches
+//                  that give up on any node whose f cost is over a
+//                  threshold; each new iteration raises the
+//                  threshold to the lowest f that went over it. The
+//                  first path found is optimal.
+//
+//                  Only the current path is kept (a stack of nodes
+//                  and arc cursors, plus one bit per node to stop
+//                  it looping), so memory grows with the path
+//                  length instead of the explored region. The price
+//                  is time: nodes reached by several routes are
+//                  expanded once per route and iteration, so it
+//                  suits small or tree-like graphs best.
+//
+//                  Uses GraphCSR::heuristic, the estimate
+//                  Graph::setHeuristics stores, worked out when a
+//                  node is reached rather than kept per node.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class IDAStar {
+private:
+	struct Frame {
+		int node;
+		int arc;
+		NodeType gCost;
+	};
+
+	const GraphCSR<NodeType, ArcType>& m_graph;
+	std::vector<Frame> m_stack;
+	std::vector<bool> m_onPath;
+	int m_expanded;
+	int m_iterations;
+
+	static const NodeType INFINITE_COST;
+
+public:
+	IDAStar(const GraphCSR<NodeType, ArcType>& graph) :
+	m_graph(graph),
+	m_expanded(0),
+	m_iterations(0) {
+	}
+
+	bool search(int start, int dest, std::vector<int>& path);
+
+    // Accessors
+	int expanded() const {
+		return m_expanded;
+	}
+
+	int iterations() const {
+		return m_iterations;
+	}
+};
+
+template<class NodeType, class ArcType>
+const NodeType IDAStar<NodeType, ArcType>::INFINITE_COST = std::numeric_limits<NodeType>::max();
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Finds the cheapest path between two nodes.
+//  Arguments:      The start and destination node indices and the
+//                  vector the path (start to dest) is written to.
+//  Return Value:   true if a path was found.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool IDAStar<NodeType, ArcType>::search(int start, int dest, std::vector<int>& path) {
+	int count = m_graph.nodeCount();
+	m_expanded = 0;
+	m_iterations = 0;
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+	m_onPath.assign(count, false);
+
+	NodeType threshold = m_graph.heuristic(start, dest);
+	while (start != dest) {
+		NodeType next = INFINITE_COST;
+		m_iterations++;
+		m_stack.clear();
+		Frame root = { start, m_graph.arcBegin(start), NodeType() };
+		m_stack.push_back(root);
+		m_onPath[start] = true;
+		m_expanded++;
+
+		while (m_stack.empty() == false) {
+			Frame& frame = m_stack.back();
+			if (frame.arc == m_graph.arcEnd(frame.node)) {
+				m_onPath[frame.node] = false;
+				m_stack.pop_back();
+				continue;
+			}
+
+			int arc = frame.arc++;
+			int child = m_graph.target(arc);
+			if (m_onPath[child])
+				continue;
+			NodeType Gc = frame.gCost + m_graph.weight(arc);
+			NodeType Fc = Gc + m_graph.heuristic(child, dest);
+			if (Fc > threshold) {
+				if (Fc < next)
+					next = Fc;
+				continue;
+			}
+
+			if (child == dest) {
+				path.clear();
+				for (const Frame& onPath : m_stack) {
+					path.push_back(onPath.node);
+					m_onPath[onPath.node] = false;
+				}
+				path.push_back(dest);
+				return true;
+			}
+
+			// frame may dangle once the stack grows
+			Frame deeper = { child, m_graph.arcBegin(child), Gc };
+			m_stack.push_back(deeper);
+			m_onPath[child] = true;
+			m_expanded++;
+		}
+
+		if (next == INFINITE_COST)
+			return false;
+		threshold = next;
+	}
+
+	path.clear();
+	path.push_back(start);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           SMAStar
+//  Description:    Simplified memory-bounded A*. Best first like
+//                  A*, but the search tree may hold at most a fixed
+//                  number of nodes. When it is full the leaf with
+//                  the highest f cost is dropped and its parent
+//                  remembers that f (the forgotten cost), so the
+//                  branch is only grown again once everything else
+//                  looks worse. The path found is optimal as long
+//                  as the budget can hold it and the nodes beside
+//                  it; otherwise the search fails rather than going
+//                  over the budget.
+//
+//                  Nodes are tree nodes, so a graph node reached
+//                  by two routes takes two of them. Parent f costs
+//                  are carried down (pathmax), which keeps f from
+//                  falling along a path. Each record remembers the
+//                  cost every dropped child was forgotten at, so a
+//                  child grown back is never cheaper than it was,
+//                  and a branch found to lead nowhere (no way on
+//                  within the budget) is not grown again at all.
+//
+//                  Uses GraphCSR::heuristic, the estimate
+//                  Graph::setHeuristics stores.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class SMAStar {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    What a record knows of each arc leaving its
+//                  node: the child is not in the tree (it was never
+//                  added, or was dropped and may be grown back),
+//                  is in the tree, or cannot lead to dest.
+// ----------------------------------------------------------------
+	enum ArcState {
+		MISSING,
+		PRESENT,
+		DEAD
+	};
+
+// ----------------------------------------------------------------
+//  Description:    One node of the search tree, reached from its
+//                  parent along arc. Children are a doubly linked
+//                  list so any of them can be dropped. arcStates
+//                  and arcCosts have an entry per arc of the node;
+//                  arcCosts holds the f cost a missing child was
+//                  forgotten at. An unexpanded record is a leaf
+//                  queued on its f cost; an expanded one is queued
+//                  on its forgotten cost (the least of its missing
+//                  children's), if it has one, to grow them back.
+// ----------------------------------------------------------------
+	struct Record {
+		int node;
+		int arc;
+		int parent;
+		int firstChild;
+		int previousSibling;
+		int nextSibling;
+		int depth;
+		NodeType gCost;
+		NodeType fCost;
+		NodeType forgotten;
+		bool expanded;
+		std::vector<unsigned char> arcStates;
+		std::vector<NodeType> arcCosts;
+	};
+
+	struct Key {
+		NodeType cost;
+		int depth;
+		int record;
+
+		// lower cost first; on equal cost prefer the deeper record
+		bool operator<(const Key& other) const {
+			if (cost != other.cost)
+				return cost < other.cost;
+			if (depth != other.depth)
+				return depth > other.depth;
+			return record < other.record;
+		}
+	};
+
+	struct Successor {
+		int arc;
+		NodeType gCost;
+		NodeType fCost;
+
+		bool operator<(const Successor& other) const {
+			return fCost < other.fCost;
+		}
+	};
+
+	const GraphCSR<NodeType, ArcType>& m_graph;
+	int m_budget;
+
+	std::vector<Record> m_records;
+	std::vector<int> m_free;
+	std::set<Key> m_open;
+	std::vector<Successor> m_successors;
+	int m_dest;
+	int m_expanding;
+	int m_expanded;
+	int m_dropped;
+
+	static const NodeType INFINITE_COST;
+
+	Key key(int record) const {
+		const Record& r = m_records[record];
+		Key k = { r.expanded ? r.forgotten : r.fCost, r.depth, record };
+		return k;
+	}
+
+	void unqueue(int record) {
+		m_open.erase(key(record));
+	}
+
+	void queue(int record) {
+		if (m_records[record].expanded == false || m_records[record].forgotten != INFINITE_COST)
+			m_open.insert(key(record));
+	}
+
+	int create(int parent, int arc, int node, NodeType gCost, NodeType fCost);
+	void drop(int record);
+	bool dropWorstLeaf(NodeType cost);
+	bool onBranch(int record, int node) const;
+	bool expand(int record);
+
+public:
+	SMAStar(const GraphCSR<NodeType, ArcType>& graph, int budget) :
+	m_graph(graph),
+	m_budget(std::max(budget, 1)),
+	m_dest(-1),
+	m_expanding(-1),
+	m_expanded(0),
+	m_dropped(0) {
+	}
+
+	bool search(int start, int dest, std::vector<int>& path);
+
+    // Accessors
+	int budget() const {
+		return m_budget;
+	}
+
+	int expanded() const {
+		return m_expanded;
+	}
+
+	// leaves dropped to stay inside the budget by the last search
+	int dropped() const {
+		return m_dropped;
+	}
+};
+
+template<class NodeType, class ArcType>
+const NodeType SMAStar<NodeType, ArcType>::INFINITE_COST = std::numeric_limits<NodeType>::max();
+
+template<class NodeType, class ArcType>
+int SMAStar<NodeType, ArcType>::create(int parent, int arc, int node, NodeType gCost, NodeType fCost) {
+	int record = m_free.back();
+	m_free.pop_back();
+	Record& r = m_records[record];
+	r.node = node;
+	r.arc = arc;
+	r.parent = parent;
+	r.firstChild = -1;
+	r.previousSibling = -1;
+	r.nextSibling = -1;
+	r.depth = 0;
+	r.gCost = gCost;
+	r.fCost = fCost;
+	r.forgotten = INFINITE_COST;
+	r.expanded = false;
+	r.arcStates.assign(m_graph.arcEnd(node) - m_graph.arcBegin(node), MISSING);
+	r.arcCosts.assign(r.arcStates.size(), NodeType());
+	if (parent != -1) {
+		Record& p = m_records[parent];
+		r.depth = p.depth + 1;
+		r.nextSibling = p.firstChild;
+		if (p.firstChild != -1)
+			m_records[p.firstChild].previousSibling = record;
+		p.firstChild = record;
+		p.arcStates[arc - m_graph.arcBegin(p.node)] = PRESENT;
+	}
+	queue(record);
+	return record;
+}
+
+// ----------------------------------------------------------------
+//  Name:           drop
+//  Description:    Removes a childless record and passes its f cost
+//                  to its parent, which keeps it for the arc, or
+//                  marks the arc dead if the cost is infinite. A parent left with no children
+//                  becomes a leaf again, queued on the best cost it
+//                  forgot, or is dropped too if that is infinite
+//                  (every branch below it was a dead end). The
+//                  record being expanded only takes the cost; it
+//                  settles its own state afterwards.
+//  Arguments:      The record.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void SMAStar<NodeType, ArcType>::drop(int record) {
+	while (record != -1) {
+		Record& r = m_records[record];
+		unqueue(record);
+		m_free.push_back(record);
+		int parent = r.parent;
+		if (parent == -1)
+			return;
+
+		Record& p = m_records[parent];
+		if (r.previousSibling != -1)
+			m_records[r.previousSibling].nextSibling = r.nextSibling;
+		else
+			p.firstChild = r.nextSibling;
+		if (r.nextSibling != -1)
+			m_records[r.nextSibling].previousSibling = r.previousSibling;
+		int arcIndex = r.arc - m_graph.arcBegin(p.node);
+		p.arcStates[arcIndex] = r.fCost == INFINITE_COST ? DEAD : MISSING;
+		p.arcCosts[arcIndex] = r.fCost;
+
+		unqueue(parent);
+		p.forgotten = std::min(p.forgotten, r.fCost);
+		record = -1;
+		if (parent == m_expanding)
+			return;
+		if (p.firstChild == -1) {
+			if (p.forgotten == INFINITE_COST) {
+				p.fCost = INFINITE_COST;
+				record = parent;
+				continue;
+			}
+			p.expanded = false;
+			p.fCost = std::max(p.fCost, p.forgotten);
+			p.forgotten = INFINITE_COST;
+		}
+		queue(parent);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           dropWorstLeaf
+//  Description:    Frees one record by dropping the leaf with the
+//                  highest f cost (the shallowest on a tie), as
+//                  long as it is worse than the successor that
+//                  needs the room. The record being expanded is not
+//                  queued, so any leaf may go, its own children
+//                  included.
+//  Arguments:      The f cost of the successor.
+//  Return Value:   false if no leaf could be dropped.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool SMAStar<NodeType, ArcType>::dropWorstLeaf(NodeType cost) {
+	typename std::set<Key>::reverse_iterator iter = m_open.rbegin();
+	for (; iter != m_open.rend(); ++iter) {
+		if (iter->cost <= cost)
+			return false;
+		if (m_records[iter->record].expanded == false) {
+			m_dropped++;
+			drop(iter->record);
+			return true;
+		}
+	}
+	return false;
+}
+
+template<class NodeType, class ArcType>
+bool SMAStar<NodeType, ArcType>::onBranch(int record, int node) const {
+	for (; record != -1; record = m_records[record].parent) {
+		if (m_records[record].node == node)
+			return true;
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           expand
+//  Description:    Adds the missing children of a record, cheapest
+//                  first, dropping worse leaves for room. Children
+//                  that do not fit are left to the record's
+//                  forgotten cost. Children grown back take the
+//                  cost they were forgotten at, so a dropped branch
+//                  is not retried for less. Arcs back onto the
+//                  branch, and arcs to nodes the budget could not
+//                  go on from (other than dest), are marked dead.
+//
+//                  Costs kept in the tree only ever rise and dead
+//                  arcs stay dead, which is what keeps the search
+//                  from going round in circles.
+//  Arguments:      The record.
+//  Return Value:   false if the budget is too small to go on.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool SMAStar<NodeType, ArcType>::expand(int record) {
+	unqueue(record);
+	m_expanded++;
+
+	// every child not in the tree is known to cost at least this
+	NodeType floor = m_records[record].expanded ? m_records[record].forgotten : m_records[record].fCost;
+	m_successors.clear();
+	{
+		Record& r = m_records[record];
+		int arcBegin = m_graph.arcBegin(r.node);
+		for (int arc = arcBegin; arc < m_graph.arcEnd(r.node); arc++) {
+			unsigned char& state = r.arcStates[arc - arcBegin];
+			if (state != MISSING)
+				continue;
+			// a child as deep as the budget goes cannot have children
+			// of its own, so it only helps if it is dest
+			int child = m_graph.target(arc);
+			if (r.depth + 1 >= m_budget || (r.depth + 2 >= m_budget && child != m_dest) || onBranch(record, child)) {
+				state = DEAD;
+				continue;
+			}
+			Successor successor;
+			successor.arc = arc;
+			successor.gCost = r.gCost + m_graph.weight(arc);
+			successor.fCost = std::max(floor, successor.gCost + m_graph.heuristic(child, m_dest));
+			successor.fCost = std::max(successor.fCost, r.arcCosts[arc - arcBegin]);
+			m_successors.push_back(successor);
+		}
+	}
+	std::sort(m_successors.begin(), m_successors.end());
+
+	m_expanding = record;
+	m_records[record].expanded = true;
+	m_records[record].forgotten = INFINITE_COST;
+	for (const Successor& successor : m_successors) {
+		if (m_free.empty() && dropWorstLeaf(successor.fCost) == false) {
+			// the rest are no cheaper than this one
+			m_records[record].forgotten = std::min(m_records[record].forgotten, successor.fCost);
+			break;
+		}
+		create(record, successor.arc, m_graph.target(successor.arc), successor.gCost, successor.fCost);
+	}
+	m_expanding = -1;
+
+	Record& r = m_records[record];
+	if (r.firstChild != -1) {
+		queue(record);
+		return true;
+	}
+	if (r.forgotten == INFINITE_COST) {
+		// a dead end, which should not hold up its parent
+		r.fCost = INFINITE_COST;
+		drop(record);
+		return true;
+	}
+	// no room even for the cheapest child, and nothing worse to make
+	// room for it: popping this record again would not help
+	if (r.forgotten == floor)
+		return false;
+	// wait until the cheaper leaves have been looked at
+	r.expanded = false;
+	r.fCost = r.forgotten;
+	r.forgotten = INFINITE_COST;
+	queue(record);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Finds the cheapest path between two nodes
+//                  without holding more tree nodes than the budget.
+//  Arguments:      The start and destination node indices and the
+//                  vector the path (start to dest) is written to.
+//  Return Value:   true if a path was found; false if there is none
+//                  or it does not fit in the budget.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool SMAStar<NodeType, ArcType>::search(int start, int dest, std::vector<int>& path) {
+	int count = m_graph.nodeCount();
+	m_expanded = 0;
+	m_dropped = 0;
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return false;
+
+	m_dest = dest;
+	m_records.resize(m_budget);
+	m_free.clear();
+	for (int i = m_budget - 1; i >= 0; i--)
+		m_free.push_back(i);
+	m_open.clear();
+	create(-1, -1, start, NodeType(), m_graph.heuristic(start, dest));
+
+	while (m_open.empty() == false) {
+		int best = m_open.begin()->record;
+		const Record& r = m_records[best];
+		if (r.node == dest && r.expanded == false) {
+			path.clear();
+			for (int record = best; record != -1; record = m_records[record].parent)
+				path.push_back(m_records[record].node);
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+		if (expand(best) == false)
+			return false;
+	}
+	return false;
+}
+
+#endif
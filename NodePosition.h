@@ -0,0 +1,18 @@
+#ifndef NODEPOSITION_H
+#define NODEPOSITION_H
+
+// -------------------------------------------------------
+// Name:        NodePosition
+// Description: A plain 2D position for a node. The graph
+//              only needs it for its heuristics, so it is
+//              kept free of any rendering library.
+// -------------------------------------------------------
+struct NodePosition {
+	float x;
+	float y;
+
+	NodePosition() : x(0), y(0) {}
+	NodePosition(float px, float py) : x(px), y(py) {}
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef OCCUPANCYGRID_H
+#define OCCUPANCYGRID_H
+
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+// ----------------------------------------------------------------
+//  Name:           OccupancyGrid
+//  Description:    A tile map stored one bit per cell, set when the
+//                  cell is blocked. Cell (x, y) has the index
+//                  y * width + x, which is also its node index in
+//                  the grid searches. Cells outside the map read as
+//                  blocked.
+// ----------------------------------------------------------------
+class OccupancyGrid {
+private:
+	int m_width;
+	int m_height;
+	std::vector<unsigned int> m_bits;
+
+public:
+	OccupancyGrid(int width, int height) :
+	m_width(width),
+	m_height(height),
+	m_bits(((std::size_t)width * height + 31) / 32, 0) {
+	}
+
+    // Accessors
+	int width() const {
+		return m_width;
+	}
+
+	int height() const {
+		return m_height;
+	}
+
+	int cellCount() const {
+		return m_width * m_height;
+	}
+
+	int index(int x, int y) const {
+		return (y * m_width) + x;
+	}
+
+	bool passable(int x, int y) const {
+		if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+			return false;
+		int cell = index(x, y);
+		return (m_bits[cell >> 5] & (1u << (cell & 31))) == 0;
+	}
+
+	void setBlocked(int x, int y, bool blocked) {
+		int cell = index(x, y);
+		if (blocked)
+			m_bits[cell >> 5] |= (1u << (cell & 31));
+		else
+			m_bits[cell >> 5] &= ~(1u << (cell & 31));
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           GridMoveCosts
+//  Description:    Cost of a straight and a diagonal step between
+//                  cells: 1 and sqrt(2) for floating point costs,
+//                  10 and 14 for integer ones so diagonals stay
+//                  cheaper than two straight steps.
+// ----------------------------------------------------------------
+template<class NodeType, bool Integral = std::is_integral<NodeType>::value>
+struct GridMoveCosts {
+	static NodeType straight() {
+		return (NodeType)1;
+	}
+
+	static NodeType diagonal() {
+		return (NodeType)1.41421356;
+	}
+};
+
+template<class NodeType>
+struct GridMoveCosts<NodeType, true> {
+	static NodeType straight() {
+		return 10;
+	}
+
+	static NodeType diagonal() {
+		return 14;
+	}
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef ONETOMANYSEARCH_H
+#define ONETOMANYSEARCH_H
+
+#include <vector>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+
+// ----------------------------------------------------------------
+//  Name:           OneToManySearch
+//  Description:    Costs from one start node to a set of targets
+//                  with a single Dijkstra search, rather than one
+//                  A* search per target each covering the same
+//                  ground again. The search stops as soon as the
+//                  last target is settled.
+//
+//                  The costs and the shortest path tree stay in the
+//                  context afterwards, so paths to any of the
+//                  targets can be read back with path() until the
+//                  context is used again.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class OneToManySearch {
+private:
+	const GraphCSR<NodeType, ArcType>& m_graph;
+
+// ----------------------------------------------------------------
+//  Description:    A node is a target of the current query while
+//                  its mark equals m_stamp, so a new query clears
+//                  the marks by bumping the stamp. Kept here rather
+//                  than in the context so nothing of the query is
+//                  left in the context's costs.
+// ----------------------------------------------------------------
+	std::vector<unsigned int> m_targetMarks;
+	unsigned int m_stamp;
+
+public:
+	OneToManySearch(const GraphCSR<NodeType, ArcType>& graph) :
+	m_graph(graph),
+	m_stamp(0) {
+	}
+
+	template<class OpenList>
+	bool query(int start, const std::vector<int>& targets, std::vector<NodeType>& costs, SearchContext<NodeType, OpenList>& context);
+	template<class OpenList>
+	bool path(int target, std::vector<int>& path, const SearchContext<NodeType, OpenList>& context) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    Settles nodes in cost order from the start until
+//                  every target is settled or nothing is left. The
+//                  context is reset first.
+//  Arguments:      The start node index, the target node indices
+//                  (repeats are fine), the vector each target's
+//                  cost is written to, in the order of targets, and
+//                  the search context. A target that cannot be
+//                  reached gets a cost of -1.
+//  Return Value:   true if every target was reached.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool OneToManySearch<NodeType, ArcType>::query(int start, const std::vector<int>& targets, std::vector<NodeType>& costs, SearchContext<NodeType, OpenList>& context) {
+	typedef SearchContext<NodeType, OpenList> Context;
+	int count = m_graph.nodeCount();
+	costs.assign(targets.size(), NodeType(-1));
+	if (start < 0 || start >= count)
+		return false;
+	if (context.size() < count)
+		context.resize(count);
+	context.reset();
+	if ((int)m_targetMarks.size() < count)
+		m_targetMarks.assign(count, 0);
+	m_stamp++;
+	// after the counter wraps old marks could look current again
+	if (m_stamp == 0) {
+		std::fill(m_targetMarks.begin(), m_targetMarks.end(), 0);
+		m_stamp = 1;
+	}
+
+	int remaining = 0;
+	bool valid = true;
+	for (int target : targets) {
+		if (target < 0 || target >= count) {
+			valid = false;
+		}
+		else if (m_targetMarks[target] != m_stamp) {
+			m_targetMarks[target] = m_stamp;
+			remaining++;
+		}
+	}
+
+	OpenList& open = context.openList();
+	context.setState(start, Context::OPEN);
+	context.setGCost(start, NodeType());
+	open.push(start, NodeType(), NodeType());
+
+	while (remaining > 0 && open.empty() == false) {
+		int current = open.pop();
+		if (context.state(current) == Context::CLOSED)
+			continue;
+		context.setState(current, Context::CLOSED);
+		if (m_targetMarks[current] == m_stamp)
+			remaining--;
+
+		NodeType currentG = context.gCost(current);
+		m_graph.forEachArc(current, [&](int child, ArcType weight) {
+			if (context.state(child) == Context::CLOSED)
+				return;
+			NodeType Gc = currentG + weight;
+			if (context.state(child) == Context::OPEN && Gc >= context.gCost(child))
+				return;
+			context.setState(child, Context::OPEN);
+			context.setGCost(child, Gc);
+			context.setPrevious(child, current);
+			open.push(child, Gc, Gc);
+		});
+	}
+
+	for (size_t i = 0; i < targets.size(); i++) {
+		int target = targets[i];
+		if (target >= 0 && target < count && context.state(target) == Context::CLOSED)
+			costs[i] = context.gCost(target);
+	}
+	return valid && remaining == 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           path
+//  Description:    Reads the path to one target back out of the
+//                  context filled by the last query.
+//  Arguments:      The target node index, the vector the path
+//                  (start to target) is written to and the context.
+//  Return Value:   true if the last query reached the target.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+bool OneToManySearch<NodeType, ArcType>::path(int target, std::vector<int>& path, const SearchContext<NodeType, OpenList>& context) const {
+	if (target < 0 || target >= context.size() || context.state(target) != SearchContext<NodeType, OpenList>::CLOSED)
+		return false;
+
+	path.clear();
+	for (int node = target; node != -1; node = context.previous(node))
+		path.push_back(node);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+#endif
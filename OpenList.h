@@ -0,0 +1,395 @@
+#ifndef OPENLIST_H
+#define OPENLIST_H
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+
+// ----------------------------------------------------------------
+//  Open lists used by the searches. All have the same interface:
+//
+//      resize(nodeCount)   size for a graph and empty the list
+//      clear()             empty the list
+//      empty()             true if nothing is left to expand
+//      push(node, f, g)    add a node, or lower the key of a node
+//                          that is already queued
+//      pop()               remove and return the node with the
+//                          lowest key
+//      topCost()           the key of the entry pop() returns next
+//
+//  They are picked with the OpenList template parameter of
+//  SearchContext, which defaults to DefaultOpenList<NodeType>::type.
+// ----------------------------------------------------------------
+
+// ----------------------------------------------------------------
+//  Name:           OpenEntry
+//  Description:    A heap entry. The f cost, and the g cost used to
+//                  break ties, are stored next to the node index so
+//                  comparing two entries never leaves the heap's
+//                  own array.
+// ----------------------------------------------------------------
+template<class NodeType>
+struct OpenEntry {
+	NodeType fCost;
+	NodeType gCost;
+	int node;
+
+	OpenEntry() {}
+	OpenEntry(int n, NodeType f, NodeType g) : fCost(f), gCost(g), node(n) {}
+
+	// lower f first; on equal f prefer the deeper node (higher g)
+	bool before(const OpenEntry& other) const {
+		return fCost < other.fCost || (fCost == other.fCost && gCost > other.gCost);
+	}
+};
+
+template<class NodeType>
+struct OpenEntryGreater {
+	bool operator()(const OpenEntry<NodeType>& a, const OpenEntry<NodeType>& b) const {
+		return b.before(a);
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           LazyOpenList
+//  Description:    Binary heap without decrease-key. A node whose
+//                  cost improves is pushed again and the old entry
+//                  is left behind; the search skips it when it is
+//                  popped because the node is already closed.
+// ----------------------------------------------------------------
+template<class NodeType>
+class LazyOpenList {
+private:
+	typedef OpenEntry<NodeType> Entry;
+
+	std::vector<Entry> m_heap;
+
+public:
+	void resize(int) {
+		m_heap.clear();
+	}
+
+	void clear() {
+		m_heap.clear();
+	}
+
+	bool empty() const {
+		return m_heap.empty();
+	}
+
+	int size() const {
+		return (int)m_heap.size();
+	}
+
+	void push(int node, NodeType fCost, NodeType gCost) {
+		m_heap.push_back(Entry(node, fCost, gCost));
+		std::push_heap(m_heap.begin(), m_heap.end(), OpenEntryGreater<NodeType>());
+	}
+
+	NodeType topCost() {
+		return m_heap.front().fCost;
+	}
+
+	int pop() {
+		std::pop_heap(m_heap.begin(), m_heap.end(), OpenEntryGreater<NodeType>());
+		int node = m_heap.back().node;
+		m_heap.pop_back();
+		return node;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           IndexedOpenList
+//  Description:    Binary heap that remembers where every node sits
+//                  in the heap, so a queued node's key can be
+//                  lowered in place (decrease-key). Each node is in
+//                  the heap at most once.
+// ----------------------------------------------------------------
+template<class NodeType>
+class IndexedOpenList {
+private:
+	typedef OpenEntry<NodeType> Entry;
+
+// ----------------------------------------------------------------
+//  Description:    The heap itself. Keys live in the entries, so
+//                  sifting only compares entries of this array.
+// ----------------------------------------------------------------
+	std::vector<Entry> m_heap;
+
+// ----------------------------------------------------------------
+//  Description:    Position of every node in m_heap, -1 if the
+//                  node is not queued. Only written when an entry
+//                  moves, never read by comparisons.
+// ----------------------------------------------------------------
+	std::vector<int> m_position;
+
+	void place(int index, const Entry& entry) {
+		m_heap[index] = entry;
+		m_position[entry.node] = index;
+	}
+
+	void siftUp(int index, const Entry& entry);
+	void siftDown(int index, const Entry& entry);
+
+public:
+	void resize(int nodeCount);
+	void clear();
+	void push(int node, NodeType fCost, NodeType gCost);
+	int pop();
+
+	bool empty() const {
+		return m_heap.empty();
+	}
+
+	int size() const {
+		return (int)m_heap.size();
+	}
+
+	bool contains(int node) const {
+		return m_position[node] != -1;
+	}
+
+	// calls visit(node) for every queued node, in no particular order
+	template<class Visitor>
+	void forEachNode(Visitor visit) const {
+		for (const Entry& entry : m_heap)
+			visit(entry.node);
+	}
+
+	NodeType topCost() {
+		return m_heap[0].fCost;
+	}
+};
+
+template<class NodeType>
+void IndexedOpenList<NodeType>::resize(int nodeCount) {
+	m_heap.clear();
+	m_position.assign(nodeCount, -1);
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Empties the heap. Only the nodes still queued
+//                  are touched, not the whole position map.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType>
+void IndexedOpenList<NodeType>::clear() {
+	for (const Entry& entry : m_heap)
+		m_position[entry.node] = -1;
+	m_heap.clear();
+}
+
+// ----------------------------------------------------------------
+//  Name:           push
+//  Description:    Queues a node, or lowers its key if it is
+//                  already queued with a higher one.
+//  Arguments:      The node index, its f cost and its g cost.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType>
+void IndexedOpenList<NodeType>::push(int node, NodeType fCost, NodeType gCost) {
+	Entry entry(node, fCost, gCost);
+	int index = m_position[node];
+	if (index == -1) {
+		m_heap.push_back(entry);
+		siftUp((int)m_heap.size() - 1, entry);
+	}
+	else if (entry.before(m_heap[index])) {
+		siftUp(index, entry);
+	}
+}
+
+template<class NodeType>
+int IndexedOpenList<NodeType>::pop() {
+	int node = m_heap[0].node;
+	m_position[node] = -1;
+	Entry last = m_heap.back();
+	m_heap.pop_back();
+	if (m_heap.empty() == false)
+		siftDown(0, last);
+	return node;
+}
+
+// ----------------------------------------------------------------
+//  Name:           siftUp
+//  Description:    Moves parents down until the entry fits, then
+//                  writes it once (a hole instead of swaps).
+//  Arguments:      The starting slot and the entry to place.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType>
+void IndexedOpenList<NodeType>::siftUp(int index, const Entry& entry) {
+	while (index > 0) {
+		int parent = (index - 1) / 2;
+		if (entry.before(m_heap[parent]) == false)
+			break;
+		place(index, m_heap[parent]);
+		index = parent;
+	}
+	place(index, entry);
+}
+
+template<class NodeType>
+void IndexedOpenList<NodeType>::siftDown(int index, const Entry& entry) {
+	int count = (int)m_heap.size();
+	for (;;) {
+		int child = (index * 2) + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count && m_heap[child + 1].before(m_heap[child]))
+			child++;
+		if (m_heap[child].before(entry) == false)
+			break;
+		place(index, m_heap[child]);
+		index = child;
+	}
+	place(index, entry);
+}
+
+// ----------------------------------------------------------------
+//  Name:           RadixOpenList
+//  Description:    Radix heap for integer costs. Entries sit in
+//                  buckets by the highest bit in which their key
+//                  differs from the last key popped, so push is
+//                  O(1) and pop is amortised O(bits in the key)
+//                  rather than O(log n) comparisons.
+//
+//                  It relies on keys never dropping below the last
+//                  key popped, which holds for Dijkstra and for A*
+//                  with a consistent heuristic, but not for the
+//                  straight line heuristic on maps whose arcs can
+//                  be shorter than the distance they span. A
+//                  smaller key would be popped out of order, so
+//                  debug builds assert on one. It is never picked
+//                  by default; ask for it with
+//                      SearchContext<int, RadixOpenList<int> >
+// ----------------------------------------------------------------
+template<class NodeType>
+class RadixOpenList {
+private:
+	static_assert(std::is_integral<NodeType>::value, "RadixOpenList needs integer costs");
+
+	typedef OpenEntry<NodeType> Entry;
+	typedef typename std::make_unsigned<NodeType>::type Key;
+
+	static const int BUCKET_COUNT = (int)(sizeof(Key) * 8) + 1;
+
+// ----------------------------------------------------------------
+//  Description:    Bucket 0 holds keys equal to m_last, bucket b
+//                  keys whose highest differing bit is b - 1.
+// ----------------------------------------------------------------
+	std::vector<Entry> m_buckets[BUCKET_COUNT];
+	NodeType m_last;
+	int m_size;
+
+	int bucketOf(NodeType fCost) const;
+	void refill();
+
+public:
+	RadixOpenList() : m_last(0), m_size(0) {}
+
+	void resize(int) {
+		clear();
+	}
+
+	void clear();
+	void push(int node, NodeType fCost, NodeType gCost);
+	int pop();
+
+	bool empty() const {
+		return m_size == 0;
+	}
+
+	NodeType topCost() {
+		refill();
+		return m_buckets[0].back().fCost;
+	}
+
+	int size() const {
+		return m_size;
+	}
+};
+
+template<class NodeType>
+int RadixOpenList<NodeType>::bucketOf(NodeType fCost) const {
+	if (fCost <= m_last)
+		return 0;
+	Key diff = (Key)fCost ^ (Key)m_last;
+	int bucket = 0;
+	while (diff != 0) {
+		diff >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+template<class NodeType>
+void RadixOpenList<NodeType>::clear() {
+	for (int i = 0; i < BUCKET_COUNT; i++)
+		m_buckets[i].clear();
+	m_last = 0;
+	m_size = 0;
+}
+
+template<class NodeType>
+void RadixOpenList<NodeType>::push(int node, NodeType fCost, NodeType gCost) {
+	assert(fCost >= m_last);
+	m_buckets[bucketOf(fCost)].push_back(Entry(node, fCost, gCost));
+	m_size++;
+}
+
+// ----------------------------------------------------------------
+//  Name:           refill
+//  Description:    If bucket 0 is empty, empties out the first
+//                  non-empty bucket instead: its lowest key becomes
+//                  the new last key and every entry in it moves to
+//                  a lower bucket.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType>
+void RadixOpenList<NodeType>::refill() {
+	if (m_buckets[0].empty()) {
+		int bucket = 1;
+		while (m_buckets[bucket].empty())
+			bucket++;
+
+		std::vector<Entry>& entries = m_buckets[bucket];
+		NodeType lowest = entries[0].fCost;
+		for (const Entry& entry : entries) {
+			if (entry.fCost < lowest)
+				lowest = entry.fCost;
+		}
+		m_last = lowest;
+		for (const Entry& entry : entries)
+			m_buckets[bucketOf(entry.fCost)].push_back(entry);
+		entries.clear();
+	}
+}
+
+template<class NodeType>
+int RadixOpenList<NodeType>::pop() {
+	refill();
+	int node = m_buckets[0].back().node;
+	m_buckets[0].pop_back();
+	m_size--;
+	return node;
+}
+
+// ----------------------------------------------------------------
+//  Name:           DefaultOpenList
+//  Description:    The open list a context gets when none is asked
+//                  for: the lazy binary heap, which stays correct
+//                  whatever order keys arrive in. The radix heap is
+//                  faster but only for monotone keys, so callers
+//                  that can promise those opt in to it.
+// ----------------------------------------------------------------
+template<class NodeType>
+struct DefaultOpenList {
+	typedef LazyOpenList<NodeType> type;
+};
+
+#endif
@@ -0,0 +1,113 @@
+// ----------------------------------------------------------------
+//  Times the same A* queries with each open list, so the open lists
+//  can be compared on the same machine. Needs no SFML; build it on
+//  its own, e.g.
+//      g++ -O2 -std=c++14 OpenListBenchmark.cpp -o OpenListBenchmark
+//      cl /O2 /EHsc OpenListBenchmark.cpp
+//  and run it with an optional grid side and query count:
+//      OpenListBenchmark [side] [queries]
+// ----------------------------------------------------------------
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include "Graph.h"
+
+using namespace std;
+
+typedef Graph<string, int, int> BenchGraph;
+
+// ----------------------------------------------------------------
+//  Name:           buildGrid
+//  Description:    A side x side grid with straight and diagonal
+//                  arcs in both directions and random weights, none
+//                  shorter than the straight line between its ends,
+//                  so the straight line heuristic stays consistent.
+//                  extraArcs random longer arcs per node make it
+//                  denser, which gives decrease-key more to do.
+// ----------------------------------------------------------------
+BenchGraph* buildGrid(int side, int extraArcs, unsigned int seed) {
+	mt19937 rng(seed);
+	uniform_int_distribution<int> extra(0, 20);
+	BenchGraph* graph = new BenchGraph(side * side);
+	for (int y = 0; y < side; y++) {
+		for (int x = 0; x < side; x++)
+			graph->addNode(to_string((y * side) + x), (y * side) + x, NodePosition(x * 10.f, y * 10.f));
+	}
+
+	for (int y = 0; y < side; y++) {
+		for (int x = 0; x < side; x++) {
+			int node = (y * side) + x;
+			if (x + 1 < side)
+				graph->addArc(node, node + 1, 10 + extra(rng), false);
+			if (y + 1 < side)
+				graph->addArc(node, node + side, 10 + extra(rng), false);
+			if (x + 1 < side && y + 1 < side)
+				graph->addArc(node, node + side + 1, 15 + extra(rng), false);
+			for (int i = 0; i < extraArcs; i++) {
+				int dx = (int)(rng() % 7) - 3;
+				int dy = (int)(rng() % 7) - 3;
+				if ((dx == 0 && dy == 0) || x + dx < 0 || x + dx >= side || y + dy < 0 || y + dy >= side)
+					continue;
+				int length = (int)(sqrt((float)((dx * dx) + (dy * dy))) * 10.f) + 1;
+				graph->addArc(node, node + (dy * side) + dx, length + extra(rng), true);
+			}
+		}
+	}
+	return graph;
+}
+
+// ----------------------------------------------------------------
+//  Name:           timeQueries
+//  Description:    Runs every query with one kind of context.
+//  Return Value:   The total time in milliseconds; costs gets the
+//                  cost of every query (-1 if there is no path).
+// ----------------------------------------------------------------
+template<class OpenList>
+double timeQueries(const GraphCSR<int, int>& graph, const vector<pair<int, int> >& queries, vector<int>& costs) {
+	SearchContext<int, OpenList> context(graph.nodeCount());
+	costs.clear();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (const pair<int, int>& query : queries) {
+		SearchResult<int> result = graph.distance(query.first, query.second, context);
+		costs.push_back(result.cost);
+	}
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+void runCase(const char* name, int side, int extraArcs, int queryCount) {
+	BenchGraph* graph = buildGrid(side, extraArcs, 1);
+	GraphCSR<int, int> snapshot = graph->freeze();
+	mt19937 rng(2);
+	vector<pair<int, int> > queries;
+	for (int i = 0; i < queryCount; i++)
+		queries.push_back(make_pair((int)(rng() % snapshot.nodeCount()), (int)(rng() % snapshot.nodeCount())));
+
+	vector<int> lazyCosts;
+	vector<int> indexedCosts;
+	vector<int> radixCosts;
+	double lazy = timeQueries<LazyOpenList<int> >(snapshot, queries, lazyCosts);
+	double indexed = timeQueries<IndexedOpenList<int> >(snapshot, queries, indexedCosts);
+	double radix = timeQueries<RadixOpenList<int> >(snapshot, queries, radixCosts);
+
+	cout << name << ": " << snapshot.nodeCount() << " nodes, " << snapshot.arcCount() << " arcs, "
+		<< queryCount << " queries" << endl;
+	cout << "  lazy    " << lazy << " ms" << endl;
+	cout << "  indexed " << indexed << " ms" << endl;
+	cout << "  radix   " << radix << " ms" << endl;
+	if (lazyCosts != indexedCosts || lazyCosts != radixCosts)
+		cout << "  costs differ between open lists" << endl;
+	delete graph;
+}
+
+int main(int argc, char *argv[]) {
+	int side = argc > 1 ? atoi(argv[1]) : 300;
+	int queryCount = argc > 2 ? atoi(argv[2]) : 50;
+	runCase("grid", side, 0, queryCount);
+	runCase("dense grid", side, 8, queryCount);
+	return EXIT_SUCCESS;
+}
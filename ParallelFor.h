@@ -0,0 +1,100 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+// ----------------------------------------------------------------
+//  Name:           threadCountOrDefault
+//  Description:    The number of threads to use when the caller
+//                  passed 0 (or less): one per hardware thread.
+// ----------------------------------------------------------------
+inline int threadCountOrDefault(int threadCount) {
+	if (threadCount > 0)
+		return threadCount;
+	return std::max((int)std::thread::hardware_concurrency(), 1);
+}
+
+// ----------------------------------------------------------------
+//  Name:           runThreads
+//  Description:    Calls work(thread) once on each of threadCount
+//                  threads, the calling thread being thread 0, and
+//                  waits for them all. For work in several phases,
+//                  this starts the threads once and a Barrier
+//                  separates the phases, instead of a parallelFor
+//                  per phase starting and joining threads each time.
+//  Arguments:      The number of threads and the work.
+//  Return Value:   None; returns once every thread is done.
+// ----------------------------------------------------------------
+template<class Work>
+void runThreads(int threadCount, Work work) {
+	std::vector<std::thread> threads;
+	for (int thread = 1; thread < threadCount; thread++)
+		threads.push_back(std::thread(work, thread));
+	work(0);
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+// ----------------------------------------------------------------
+//  Name:           Barrier
+//  Description:    Holds threads in wait() until all threadCount of
+//                  them have arrived, then lets them all go. Can be
+//                  used again straight away for the next phase.
+// ----------------------------------------------------------------
+class Barrier {
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_released;
+	int m_threadCount;
+	int m_waiting;
+	unsigned int m_phase;
+
+public:
+	explicit Barrier(int threadCount) :
+	m_threadCount(threadCount),
+	m_waiting(0),
+	m_phase(0) {
+	}
+
+	void wait() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		unsigned int phase = m_phase;
+		if (++m_waiting == m_threadCount) {
+			m_waiting = 0;
+			m_phase++;
+			m_released.notify_all();
+			return;
+		}
+		m_released.wait(lock, [&]() { return m_phase != phase; });
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           parallelFor
+//  Description:    Calls work(item, thread) for items 0 to
+//                  itemCount - 1 on up to threadCount threads, the
+//                  calling thread being thread 0. Items are handed
+//                  out one at a time, so a thread that drew cheap
+//                  items takes more of them. thread is below
+//                  threadCount, for indexing per thread state such
+//                  as search contexts.
+//  Arguments:      The number of items and threads, and the work.
+//  Return Value:   None; returns once every item is done.
+// ----------------------------------------------------------------
+template<class Work>
+void parallelFor(int itemCount, int threadCount, Work work) {
+	std::atomic<int> next(0);
+	auto worker = [&](int thread) {
+		for (int item = next++; item < itemCount; item = next++)
+			work(item, thread);
+	};
+
+	runThreads(std::min(threadCount, itemCount), worker);
+}
+
+#endif
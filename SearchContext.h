@@ -0,0 +1,182 @@
+#ifndef SEARCHCONTEXT_H
+#define SEARCHCONTEXT_H
+
+#include <vector>
+#include <algorithm>
+#include "OpenList.h"
+
+// ----------------------------------------------------------------
+//  Name:           SearchContext
+//  Description:    Holds the per node state of one search (costs,
+//                  parent and open/closed flags) so the graph
+//                  stays read-only while it is searched. Give
+//                  every thread its own context and reuse it
+//                  between queries.
+//
+//                  Every record carries the generation it was
+//                  written in. A record from an older generation
+//                  reads as unvisited, so reset() only has to bump
+//                  the generation instead of clearing every node.
+//
+//                  The OpenList parameter picks the priority queue
+//                  the searches use (see OpenList.h). By default it
+//                  is a binary heap, which takes keys in any order.
+//                  RadixOpenList is faster for integer costs but
+//                  needs the keys popped never to decrease, so only
+//                  choose it for Dijkstra or a consistent heuristic.
+// ----------------------------------------------------------------
+template<class NodeType, class OpenList = typename DefaultOpenList<NodeType>::type>
+class SearchContext {
+public:
+	typedef NodeType CostType;
+	typedef OpenList OpenListType;
+
+	enum NodeState {
+		UNVISITED,
+		OPEN,
+		CLOSED
+	};
+
+private:
+
+// ----------------------------------------------------------------
+//  Description:    The state of one node. Costs are -1 and
+//                  previous is -1 when not set.
+// ----------------------------------------------------------------
+	struct NodeRecord {
+		unsigned int stamp;
+		int previous;
+		NodeType hCost;
+		NodeType gCost;
+		unsigned char state;
+	};
+
+	std::vector<NodeRecord> m_records;
+
+// ----------------------------------------------------------------
+//  Description:    Records stamped with anything else are stale.
+// ----------------------------------------------------------------
+	unsigned int m_generation;
+
+	OpenList m_openList;
+
+	bool current(int node) const {
+		return m_records[node].stamp == m_generation;
+	}
+
+	// returns the record for writing, clearing it first if stale
+	NodeRecord& touch(int node) {
+		NodeRecord& record = m_records[node];
+		if (record.stamp != m_generation) {
+			record.stamp = m_generation;
+			record.previous = -1;
+			record.hCost = NodeType(-1);
+			record.gCost = NodeType(-1);
+			record.state = UNVISITED;
+		}
+		return record;
+	}
+
+public:
+	explicit SearchContext(int size = 0);
+
+	void resize(int size);
+	void reset();
+
+    // Accessors
+	int size() const {
+		return (int)m_records.size();
+	}
+
+	unsigned int generation() const {
+		return m_generation;
+	}
+
+	OpenList& openList() {
+		return m_openList;
+	}
+
+	NodeType hCost(int node) const {
+		return current(node) ? m_records[node].hCost : NodeType(-1);
+	}
+
+	NodeType gCost(int node) const {
+		return current(node) ? m_records[node].gCost : NodeType(-1);
+	}
+
+	NodeType fCost(int node) const {
+		return hCost(node) + gCost(node);
+	}
+
+	int previous(int node) const {
+		return current(node) ? m_records[node].previous : -1;
+	}
+
+	NodeState state(int node) const {
+		return current(node) ? (NodeState)m_records[node].state : UNVISITED;
+	}
+
+	bool marked(int node) const {
+		return state(node) != UNVISITED;
+	}
+
+    // Manipulators
+	void setHCost(int node, NodeType hCost) {
+		touch(node).hCost = hCost;
+	}
+
+	void setGCost(int node, NodeType gCost) {
+		touch(node).gCost = gCost;
+	}
+
+	void setPrevious(int node, int previous) {
+		touch(node).previous = previous;
+	}
+
+	void setState(int node, NodeState state) {
+		touch(node).state = (unsigned char)state;
+	}
+};
+
+template<class NodeType, class OpenList>
+SearchContext<NodeType, OpenList>::SearchContext(int size) :
+m_generation(1) {
+	resize(size);
+}
+
+// ----------------------------------------------------------------
+//  Name:           resize
+//  Description:    Sizes the context for a graph and resets it.
+//  Arguments:      The number of node slots in the graph.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class OpenList>
+void SearchContext<NodeType, OpenList>::resize(int size) {
+	NodeRecord stale = NodeRecord();
+	m_records.assign(size, stale);
+	m_generation = 1;
+	m_openList.resize(size);
+}
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Clears the state left by the previous search by
+//                  starting a new generation. Only whatever is left
+//                  in the open list is cleared node by node.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class OpenList>
+void SearchContext<NodeType, OpenList>::reset() {
+	m_openList.clear();
+	m_generation++;
+	// after the counter wraps old stamps could look current again,
+	// so pay for one full clear every 2^32 resets
+	if (m_generation == 0) {
+		for (NodeRecord& record : m_records)
+			record.stamp = 0;
+		m_generation = 1;
+	}
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SEARCHRESULT_H
+#define SEARCHRESULT_H
+
+// ----------------------------------------------------------------
+//  Name:           SearchResult
+//  Description:    What a query found, returned by value instead of
+//                  being printed. cost is the path cost whenever a
+//                  path exists (FOUND or BUFFER_TOO_SMALL), -1
+//                  otherwise. length is the number of nodes on the
+//                  path, which for BUFFER_TOO_SMALL is the capacity
+//                  the caller's buffer needs; distance-only queries
+//                  leave it 0.
+// ----------------------------------------------------------------
+template<class NodeType>
+struct SearchResult {
+	enum Status {
+		FOUND,
+		NO_PATH,
+		INVALID_NODE,
+		BUFFER_TOO_SMALL
+	};
+
+	Status status;
+	NodeType cost;
+	int length;
+
+	SearchResult() : status(NO_PATH), cost(-1), length(0) {}
+	SearchResult(Status s, NodeType c, int l) : status(s), cost(c), length(l) {}
+
+	bool found() const {
+		return status == FOUND;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           writePath
+//  Description:    Copies the path to dest out of a finished search
+//                  into a caller's buffer, start first, without
+//                  allocating: the length is counted first, then
+//                  the nodes are written from the back, so nothing
+//                  has to be reversed.
+//  Arguments:      The search context, the destination, the buffer
+//                  and its capacity (the buffer may be null if the
+//                  capacity is 0).
+//  Return Value:   The number of nodes on the path. Nothing is
+//                  written if that is more than the capacity.
+// ----------------------------------------------------------------
+template<class Context>
+int writePath(const Context& context, int dest, int* path, int capacity) {
+	int length = 0;
+	for (int node = dest; node != -1; node = context.previous(node))
+		length++;
+	if (length > capacity)
+		return length;
+
+	int slot = length;
+	for (int node = dest; node != -1; node = context.previous(node))
+		path[--slot] = node;
+	return length;
+}
+
+#endif
@@ -0,0 +1,454 @@
+#ifndef TRAVELTIMETABLE_H
+#define TRAVELTIMETABLE_H
+
+#include <vector>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include "GraphCSR.h"
+#include "SearchContext.h"
+#include "AStarSearch.h"
+#include "SearchResult.h"
+
+// ----------------------------------------------------------------
+//  Name:           TravelTimePoint
+//  Description:    One breakpoint of a travel time profile: leaving
+//                  at time, the arc takes travelTime to cross.
+// ----------------------------------------------------------------
+template<class NodeType>
+struct TravelTimePoint {
+	NodeType time;
+	NodeType travelTime;
+
+	TravelTimePoint() {}
+	TravelTimePoint(NodeType t, NodeType c) : time(t), travelTime(c) {}
+
+	bool operator<(const TravelTimePoint& other) const {
+		return time < other.time || (time == other.time && travelTime < other.travelTime);
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           TravelTimeTable
+//  Description:    Time dependent arc costs for a snapshot. An arc
+//                  can be given a travel time profile, a piecewise
+//                  linear function of the time it is entered;
+//                  arcs without one keep their snapshot weight.
+//
+//                  Profiles live in one pool, breakpoints of all of
+//                  them in a single array, and adding a profile
+//                  that is already there returns the existing one,
+//                  so arcs sharing a profile (every road of a kind,
+//                  say) share its data. Each arc only holds the
+//                  index of its profile.
+//
+//                  Every profile must be FIFO: entering an arc
+//                  later never gets you out sooner, so no segment
+//                  may fall faster than time passes. With that,
+//                  the earliest arrival at a node is also the best
+//                  time to leave it, and search() is an ordinary
+//                  label setting A* in which each arc is costed at
+//                  the time its tail node is reached.
+//
+//                  With a period (a day, say) times wrap around it
+//                  and the last breakpoint joins the first one of
+//                  the next period; without one, profiles are flat
+//                  before their first and after their last
+//                  breakpoint.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class TravelTimeTable {
+public:
+	typedef TravelTimePoint<NodeType> Point;
+
+private:
+	const GraphCSR<NodeType, ArcType>& m_graph;
+	NodeType m_period;
+
+// ----------------------------------------------------------------
+//  Description:    Profile p's breakpoints, in time order, are
+//                  m_points[m_profileOffsets[p]] up to
+//                  m_points[m_profileOffsets[p + 1]]. m_minimum[p]
+//                  is the least travel time p ever gives.
+//                  m_sortedProfiles holds every profile index once,
+//                  ordered by comparing the breakpoints, so that
+//                  addProfile() can find a duplicate by binary
+//                  search without keeping a second copy of them.
+// ----------------------------------------------------------------
+	std::vector<Point> m_points;
+	std::vector<int> m_profileOffsets;
+	std::vector<NodeType> m_minimum;
+	std::vector<int> m_sortedProfiles;
+
+// ----------------------------------------------------------------
+//  Description:    The profile of every snapshot arc, -1 for the
+//                  arcs that keep their weight.
+// ----------------------------------------------------------------
+	std::vector<int> m_arcProfiles;
+
+// ----------------------------------------------------------------
+//  Description:    The least cost per unit of straight line
+//                  distance over all arcs at any time, so that
+//                  distance times it never overestimates a travel
+//                  time. Worked out by refreshBounds().
+// ----------------------------------------------------------------
+	float m_costPerDistance;
+
+// ----------------------------------------------------------------
+//  Description:    The snapshot as search() sees it: arcs are
+//                  costed at the time their tail is reached, which
+//                  is the departure plus the tail's g cost.
+// ----------------------------------------------------------------
+	template<class Context>
+	struct TimeView {
+		const TravelTimeTable& owner;
+		const Context& context;
+		NodeType departure;
+
+		template<class Visitor>
+		void forEachArc(int node, Visitor visit) const {
+			NodeType now = departure + context.gCost(node);
+			const GraphCSR<NodeType, ArcType>& graph = owner.m_graph;
+			for (int arc = graph.arcBegin(node); arc < graph.arcEnd(node); arc++)
+				visit(graph.target(arc), owner.travelTime(arc, now));
+		}
+
+		NodeType heuristic(int node, int dest) const {
+			return (NodeType)(owner.m_costPerDistance * owner.distance(node, dest));
+		}
+	};
+
+	bool fifo(const std::vector<Point>& points) const;
+	bool profileLess(int profile, const std::vector<Point>& points) const;
+	NodeType wrap(NodeType time) const;
+	NodeType profileTime(int profile, NodeType time) const;
+	float distance(int from, int to) const;
+
+public:
+	TravelTimeTable(const GraphCSR<NodeType, ArcType>& graph, NodeType period = NodeType());
+
+	int addProfile(const std::vector<Point>& points);
+	bool setArcProfile(int arc, int profile);
+	bool setProfile(int from, int to, int profile);
+	void refreshBounds();
+
+	NodeType travelTime(int arc, NodeType time) const;
+	NodeType minimumTravelTime(int arc) const;
+
+	template<class OpenList>
+	SearchResult<NodeType> search(int start, int dest, NodeType departure, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const;
+
+    // Accessors
+	NodeType period() const {
+		return m_period;
+	}
+
+	int profileCount() const {
+		return (int)m_minimum.size();
+	}
+
+	int pointCount() const {
+		return (int)m_points.size();
+	}
+
+	int arcProfile(int arc) const {
+		return m_arcProfiles[arc];
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           TravelTimeTable
+//  Description:    Starts with every arc on its snapshot weight.
+//  Arguments:      The snapshot, which must outlive the table, and
+//                  the period times wrap around (0 for none).
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+TravelTimeTable<NodeType, ArcType>::TravelTimeTable(const GraphCSR<NodeType, ArcType>& graph, NodeType period) :
+m_graph(graph),
+m_period(period),
+m_profileOffsets(1, 0),
+m_arcProfiles(graph.arcCount(), -1),
+m_costPerDistance(0) {
+	refreshBounds();
+}
+
+// ----------------------------------------------------------------
+//  Name:           addProfile
+//  Description:    Adds a travel time profile to the pool, or finds
+//                  the identical one already there.
+//  Arguments:      The breakpoints in strictly increasing time
+//                  order. With a period they must lie in
+//                  [0, period).
+//  Return Value:   The profile's index, or -1 if the breakpoints
+//                  are empty, out of order or out of the period,
+//                  a travel time is negative, or the profile is
+//                  not FIFO.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+int TravelTimeTable<NodeType, ArcType>::addProfile(const std::vector<Point>& points) {
+	if (points.empty())
+		return -1;
+	for (size_t i = 0; i < points.size(); i++) {
+		if (points[i].travelTime < NodeType())
+			return -1;
+		if (i > 0 && points[i].time <= points[i - 1].time)
+			return -1;
+		if (m_period > NodeType() && (points[i].time < NodeType() || points[i].time >= m_period))
+			return -1;
+	}
+	if (fifo(points) == false)
+		return -1;
+
+	std::vector<int>::iterator found = std::lower_bound(m_sortedProfiles.begin(), m_sortedProfiles.end(), points,
+		[this](int profile, const std::vector<Point>& key) { return profileLess(profile, key); });
+	if (found != m_sortedProfiles.end()) {
+		const Point* begin = m_points.data() + m_profileOffsets[*found];
+		const Point* end = m_points.data() + m_profileOffsets[*found + 1];
+		if (end - begin == (std::ptrdiff_t)points.size() && std::equal(begin, end, points.begin(), [](const Point& a, const Point& b) {
+			return a.time == b.time && a.travelTime == b.travelTime;
+		}))
+			return *found;
+	}
+
+	int profile = (int)m_minimum.size();
+	NodeType minimum = points[0].travelTime;
+	for (const Point& point : points)
+		minimum = std::min(minimum, point.travelTime);
+	m_points.insert(m_points.end(), points.begin(), points.end());
+	m_profileOffsets.push_back((int)m_points.size());
+	m_minimum.push_back(minimum);
+	m_sortedProfiles.insert(found, profile);
+	return profile;
+}
+
+// ----------------------------------------------------------------
+//  Name:           profileLess
+//  Description:    Orders a pooled profile against breakpoints not
+//                  yet pooled, point by point, the shorter first
+//                  when one is a prefix of the other.
+//  Return Value:   Whether the profile comes before points.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool TravelTimeTable<NodeType, ArcType>::profileLess(int profile, const std::vector<Point>& points) const {
+	const Point* begin = m_points.data() + m_profileOffsets[profile];
+	const Point* end = m_points.data() + m_profileOffsets[profile + 1];
+	return std::lexicographical_compare(begin, end, points.begin(), points.end());
+}
+
+// ----------------------------------------------------------------
+//  Name:           fifo
+//  Description:    Whether leaving later never means arriving
+//                  earlier: time + travelTime must not fall along
+//                  any segment, including the one that wraps round
+//                  the period.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool TravelTimeTable<NodeType, ArcType>::fifo(const std::vector<Point>& points) const {
+	for (size_t i = 1; i < points.size(); i++) {
+		if (points[i].time + points[i].travelTime < points[i - 1].time + points[i - 1].travelTime)
+			return false;
+	}
+	if (m_period > NodeType()) {
+		const Point& last = points.back();
+		const Point& first = points.front();
+		if (first.time + m_period + first.travelTime < last.time + last.travelTime)
+			return false;
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           setArcProfile
+//  Description:    Gives an arc a profile from the pool, or puts it
+//                  back on its snapshot weight. Call refreshBounds()
+//                  once all arcs are set.
+//  Arguments:      The snapshot arc index and the profile index, -1
+//                  for the snapshot weight.
+//  Return Value:   false if either index is out of range.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool TravelTimeTable<NodeType, ArcType>::setArcProfile(int arc, int profile) {
+	if (arc < 0 || arc >= (int)m_arcProfiles.size() || profile < -1 || profile >= profileCount())
+		return false;
+	m_arcProfiles[arc] = profile;
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           setProfile
+//  Description:    setArcProfile for the arc between two nodes.
+//  Arguments:      The arc's source and target node indices and
+//                  the profile index, -1 for the snapshot weight.
+//  Return Value:   false if there is no such arc or profile.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool TravelTimeTable<NodeType, ArcType>::setProfile(int from, int to, int profile) {
+	return setArcProfile(m_graph.findArc(from, to), profile);
+}
+
+// ----------------------------------------------------------------
+//  Name:           refreshBounds
+//  Description:    Works out the heuristic's cost per distance from
+//                  the fastest any arc can be crossed. Call it after
+//                  setting profiles or changing snapshot weights;
+//                  until then the heuristic can overestimate.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void TravelTimeTable<NodeType, ArcType>::refreshBounds() {
+	bool first = true;
+	m_costPerDistance = 0;
+	for (int node = 0; node < m_graph.nodeCount(); node++) {
+		for (int arc = m_graph.arcBegin(node); arc < m_graph.arcEnd(node); arc++) {
+			float length = distance(node, m_graph.target(arc));
+			if (length <= 0)
+				continue;
+			float rate = (float)minimumTravelTime(arc) / length;
+			if (first || rate < m_costPerDistance)
+				m_costPerDistance = rate;
+			first = false;
+		}
+	}
+	m_costPerDistance = std::max(m_costPerDistance, 0.0f);
+}
+
+// ----------------------------------------------------------------
+//  Name:           wrap
+//  Description:    A time folded into [0, period), if there is one.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType TravelTimeTable<NodeType, ArcType>::wrap(NodeType time) const {
+	if (m_period <= NodeType())
+		return time;
+	time -= (NodeType)(long long)(time / m_period) * m_period;
+	if (time < NodeType())
+		time += m_period;
+	return time;
+}
+
+// ----------------------------------------------------------------
+//  Name:           profileTime
+//  Description:    Evaluates a profile by linear interpolation
+//                  between the breakpoints either side of a time.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType TravelTimeTable<NodeType, ArcType>::profileTime(int profile, NodeType time) const {
+	const Point* begin = m_points.data() + m_profileOffsets[profile];
+	const Point* end = m_points.data() + m_profileOffsets[profile + 1];
+	time = wrap(time);
+
+	// the first breakpoint after time, found with a binary search
+	const Point* after = begin;
+	int count = (int)(end - begin);
+	while (count > 0) {
+		int half = count / 2;
+		if (after[half].time <= time) {
+			after += half + 1;
+			count -= half + 1;
+		}
+		else {
+			count = half;
+		}
+	}
+
+	Point left;
+	Point right;
+	if (after == begin || after == end) {
+		if (m_period <= NodeType())
+			return after == begin ? begin->travelTime : (end - 1)->travelTime;
+		// between the last breakpoint and the first of the next period
+		left = *(end - 1);
+		right = *begin;
+		if (after == begin)
+			left.time -= m_period;
+		else
+			right.time += m_period;
+	}
+	else {
+		left = *(after - 1);
+		right = *after;
+	}
+	if (right.time == left.time)
+		return left.travelTime;
+	return left.travelTime + (right.travelTime - left.travelTime) * (time - left.time) / (right.time - left.time);
+}
+
+// ----------------------------------------------------------------
+//  Name:           travelTime
+//  Description:    The time an arc takes when entered at a time.
+//  Arguments:      The snapshot arc index and the time.
+//  Return Value:   The travel time.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType TravelTimeTable<NodeType, ArcType>::travelTime(int arc, NodeType time) const {
+	int profile = m_arcProfiles[arc];
+	if (profile == -1)
+		return (NodeType)m_graph.weight(arc);
+	return profileTime(profile, time);
+}
+
+// ----------------------------------------------------------------
+//  Name:           minimumTravelTime
+//  Description:    The least time an arc takes at any time.
+//  Arguments:      The snapshot arc index.
+//  Return Value:   The travel time.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeType TravelTimeTable<NodeType, ArcType>::minimumTravelTime(int arc) const {
+	int profile = m_arcProfiles[arc];
+	if (profile == -1)
+		return (NodeType)m_graph.weight(arc);
+	return m_minimum[profile];
+}
+
+// ----------------------------------------------------------------
+//  Name:           distance
+//  Description:    Straight line distance between two nodes.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float TravelTimeTable<NodeType, ArcType>::distance(int from, int to) const {
+	float dx = m_graph.position(to).x - m_graph.position(from).x;
+	float dy = m_graph.position(to).y - m_graph.position(from).y;
+	return sqrt((dx * dx) + (dy * dy));
+}
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Earliest arrival A* from a departure time. Every
+//                  arc is costed by its profile at the time its
+//                  tail node is reached; the heuristic is the
+//                  straight line distance at the fastest rate any
+//                  arc allows. The context is reset first.
+//  Arguments:      The start and destination node indices, the
+//                  departure time from start, the vector the path
+//                  (start to dest) is written to and the search
+//                  context.
+//  Return Value:   The status; cost is the total travel time, so
+//                  the arrival time is departure + cost, and length
+//                  is the number of nodes on the path.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class OpenList>
+SearchResult<NodeType> TravelTimeTable<NodeType, ArcType>::search(int start, int dest, NodeType departure, std::vector<int>& path, SearchContext<NodeType, OpenList>& context) const {
+	typedef SearchContext<NodeType, OpenList> Context;
+	typedef SearchResult<NodeType> Result;
+	int count = m_graph.nodeCount();
+	if (start < 0 || start >= count || dest < 0 || dest >= count)
+		return Result(Result::INVALID_NODE, NodeType(-1), 0);
+	if (context.size() < count)
+		context.resize(count);
+	context.reset();
+
+	TimeView<Context> view = { *this, context, departure };
+	if (aStarSearch(view, start, dest, context) == false)
+		return Result(Result::NO_PATH, NodeType(-1), 0);
+
+	path.clear();
+	for (int node = dest; node != -1; node = context.previous(node))
+		path.push_back(node);
+	std::reverse(path.begin(), path.end());
+	return Result(Result::FOUND, context.gCost(dest), (int)path.size());
+}
+
+#endif
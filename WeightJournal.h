@@ -0,0 +1,130 @@
+#ifndef WEIGHTJOURNAL_H
+#define WEIGHTJOURNAL_H
+
+#include <vector>
+#include <algorithm>
+
+// ----------------------------------------------------------------
+//  Name:           WeightUpdate
+//  Description:    One requested weight change, by arc end points.
+// ----------------------------------------------------------------
+template<class ArcType>
+struct WeightUpdate {
+	int from;
+	int to;
+	ArcType weight;
+
+	WeightUpdate() {}
+	WeightUpdate(int f, int t, ArcType w) : from(f), to(t), weight(w) {}
+};
+
+// ----------------------------------------------------------------
+//  Name:           WeightChange
+//  Description:    One applied weight change. arc is the arc's
+//                  index in a snapshot frozen from the graph when
+//                  the change was made.
+// ----------------------------------------------------------------
+template<class ArcType>
+struct WeightChange {
+	int arc;
+	int from;
+	int to;
+	ArcType oldWeight;
+	ArcType newWeight;
+	unsigned int version;
+};
+
+// ----------------------------------------------------------------
+//  Name:           WeightJournal
+//  Description:    The record of every weight change made to a
+//                  graph. Each batch of changes gets the next
+//                  version number, so anything built from the graph
+//                  (a snapshot, a planner, a precomputed index) can
+//                  remember the version it has seen and catch up
+//                  with just the changes after it.
+// ----------------------------------------------------------------
+template<class ArcType>
+class WeightJournal {
+private:
+	typedef WeightChange<ArcType> Change;
+
+	std::vector<Change> m_changes;
+	unsigned int m_version;
+
+// ----------------------------------------------------------------
+//  Description:    The oldest version a reader can catch up from;
+//                  the changes after older versions may have been
+//                  discarded.
+// ----------------------------------------------------------------
+	unsigned int m_oldest;
+
+	struct VersionLess {
+		bool operator()(const Change& change, unsigned int version) const {
+			return change.version <= version;
+		}
+	};
+
+public:
+	WeightJournal() : m_version(0), m_oldest(0) {}
+
+    // Accessors
+	unsigned int version() const {
+		return m_version;
+	}
+
+	unsigned int oldestVersion() const {
+		return m_oldest;
+	}
+
+	int size() const {
+		return (int)m_changes.size();
+	}
+
+	Change const & change(int index) const {
+		return m_changes[index];
+	}
+
+// ----------------------------------------------------------------
+//  Name:           beginBatch
+//  Description:    Starts a new version; changes recorded until the
+//                  next call share it.
+//  Arguments:      None.
+//  Return Value:   The new version.
+// ----------------------------------------------------------------
+	unsigned int beginBatch() {
+		return ++m_version;
+	}
+
+	void record(int arc, int from, int to, ArcType oldWeight, ArcType newWeight) {
+		Change change = { arc, from, to, oldWeight, newWeight, m_version };
+		m_changes.push_back(change);
+	}
+
+// ----------------------------------------------------------------
+//  Name:           forEachChangeSince
+//  Description:    Calls visit(change) for every change newer than
+//                  a version, oldest first.
+// ----------------------------------------------------------------
+	template<class Visitor>
+	void forEachChangeSince(unsigned int version, Visitor visit) const {
+		typename std::vector<Change>::const_iterator iter = std::lower_bound(m_changes.begin(), m_changes.end(), version, VersionLess());
+		for (; iter != m_changes.end(); ++iter)
+			visit(*iter);
+	}
+
+// ----------------------------------------------------------------
+//  Name:           discardUpTo
+//  Description:    Forgets the changes every reader has already
+//                  seen, so the journal does not grow forever.
+//                  Readers older than the version can no longer
+//                  catch up and have to be rebuilt.
+//  Arguments:      The oldest version any reader still has.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+	void discardUpTo(unsigned int version) {
+		m_oldest = std::max(m_oldest, std::min(version, m_version));
+		m_changes.erase(m_changes.begin(), std::lower_bound(m_changes.begin(), m_changes.end(), version, VersionLess()));
+	}
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include <string>
 #include <tuple>
 #include "Graph.h"
+#include "GraphView.h"
 
 using namespace std;
 
@@ -30,8 +31,8 @@ using namespace std;
 //typedef GraphArc<tuple<string, int, int>, int> Arc;
 typedef GraphNode<string, int, int> Node;
 
-void visit(Node * pNode) {
-	cout << "Visiting: Data= " << pNode->data() << " H(n)= " << pNode->hCost() << " G(n)= " << pNode->gCost() << endl;
+void visit(Node * pNode, const SearchContext<int>& context) {
+	cout << "Visiting: Data= " << pNode->data() << " H(n)= " << context.hCost(pNode->index()) << " G(n)= " << context.gCost(pNode->index()) << endl;
 }
 
 int main(int argc, char *argv[]) {
@@ -71,6 +72,7 @@ int main(int argc, char *argv[]) {
 	//set up graph
 	const int NODE_COUNT = 30;
 	Graph<string, int, int> graph(NODE_COUNT);
+	SearchContext<int> context(NODE_COUNT);
 	
 	//set up nodes
 	string n;
@@ -78,10 +80,10 @@ int main(int argc, char *argv[]) {
 	ifstream myfile;
 	myfile.open ("assets/nodes.txt");
 
-	sf::Vector2f graphPosition(100, 75);
-	sf::Vector2f offset;
+	NodePosition graphPosition(100, 75);
+	NodePosition offset;
 	while (myfile >> n >> offset.x >> offset.y) {
-		graph.addNode(n, i++, graphPosition + offset);
+		graph.addNode(n, i++, NodePosition(graphPosition.x + offset.x, graphPosition.y + offset.y));
 	}
 	myfile.close();
 
@@ -105,7 +107,9 @@ int main(int argc, char *argv[]) {
 		//add weight text
 		WeightDisplay wgtDisplay;
 		wgtDisplay.text = sf::Text(to_string(weight), font, 15);
-		wgtDisplay.text.setPosition(graph.nodeArray()[from]->getPosition() + ((graph.nodeArray()[to]->getPosition() - graph.nodeArray()[from]->getPosition()) / 2.f));
+		NodePosition fromPos = graph.nodeArray()[from]->getPosition();
+		NodePosition toPos = graph.nodeArray()[to]->getPosition();
+		wgtDisplay.text.setPosition(fromPos.x + ((toPos.x - fromPos.x) / 2.f), fromPos.y + ((toPos.y - fromPos.y) / 2.f));
 		wgtDisplay.text.setFillColor(sf::Color(255, 255, 128, 255));
 		wgtDisplay.text.setOrigin(8, 8);
 
@@ -121,6 +125,7 @@ int main(int argc, char *argv[]) {
 	}
     myfile.close();
 
+	GraphView<string, int, int> view(graph, font);
 
 	int startNode = 0;
 	int endNode = 17;
@@ -132,8 +137,7 @@ int main(int argc, char *argv[]) {
 
 	//display nodes in path
 	for (Node* n : path)
-		visit(n);
-	const float RADIUS = graph.nodeArray()[0]->getShape().getRadius();
+		visit(n, context);
 	// Start game loop 
 	while (window.isOpen())
 	{
@@ -150,27 +154,22 @@ int main(int argc, char *argv[]) {
 			{
 				if (Event.type == sf::Event::MouseButtonPressed)
 				{
-					for (int i = 0; i < graph.getMaxNodes(); i++)
+					int i = view.nodeAt(mousePos);
+					if (i != -1)
 					{
-						sf::Vector2f vectorBetween = graph.nodeArray()[i]->getShape().getPosition() - mousePos;
-						float distanceSquared = (vectorBetween.x * vectorBetween.x) + (vectorBetween.y * vectorBetween.y);
-						if (distanceSquared < (RADIUS * RADIUS))
+						if (setOrigin)
 						{
-							if (setOrigin)
-							{
-								originNode = i;
-								graph.nodeArray()[originNode]->setColour(sf::Color(0, 180, 0));
-								setOrigin = false;
-								break;
-							}
-							else if (setDest && setOrigin == false && i != originNode)
-							{
-								destNode = i;
-								graph.nodeArray()[destNode]->setColour(sf::Color(150, 0, 0));
-								graph.setHeuristics(graph.nodeArray()[destNode]);
-								setDest = false;
-								break;
-							}
+							originNode = i;
+							view.highlight(originNode, sf::Color(0, 180, 0));
+							setOrigin = false;
+						}
+						else if (setDest && setOrigin == false && i != originNode)
+						{
+							destNode = i;
+							view.highlight(destNode, sf::Color(150, 0, 0));
+							graph.setHeuristics(graph.nodeArray()[destNode], context);
+							view.update(context, path);
+							setDest = false;
 						}
 					}
 				}
@@ -187,9 +186,13 @@ int main(int argc, char *argv[]) {
 					mousePos.y > startButton.getPosition().y &&
 					mousePos.y < startButton.getPosition().y + startButton.getTextureRect().height){					
 
-					graph.aStar(graph.nodeArray()[originNode], graph.nodeArray()[destNode], path);
-					graph.nodeArray()[originNode]->setColour(sf::Color(0, 150, 0));
-					graph.nodeArray()[destNode]->setColour(sf::Color(180, 0, 0));
+					if (graph.aStar(graph.nodeArray()[originNode], graph.nodeArray()[destNode], path, context).found() == false)
+						cout << "Couldn't find path." << endl;
+					// the search reset the context; fill the estimates in again for display
+					graph.setHeuristics(graph.nodeArray()[destNode], context);
+					view.highlight(originNode, sf::Color(0, 150, 0));
+					view.highlight(destNode, sf::Color(180, 0, 0));
+					view.update(context, path);
 				}
 				else if (Event.type == sf::Event::MouseButtonReleased &&
 						mousePos.x > resetButton.getPosition().x &&
@@ -197,8 +200,10 @@ int main(int argc, char *argv[]) {
 						mousePos.y > resetButton.getPosition().y &&
 						mousePos.y < resetButton.getPosition().y + resetButton.getTextureRect().height){
 
-					graph.reset();
+					context.reset();
 					path.clear();
+					view.clearHighlights();
+					view.update(context, path);
 
 					originNode = NULL;
 					destNode = NULL;
@@ -211,8 +216,7 @@ int main(int argc, char *argv[]) {
 		window.clear();
 		window.draw(startButton);
 		window.draw(resetButton);
-		graph.drawArcs(window);
-		graph.drawNodes(window);
+		view.draw(window);
 		for (WeightDisplay wD : weightTexts){
 			window.draw(wD.rectangle);
 			window.draw(wD.text);